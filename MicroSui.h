@@ -1,20 +1,18 @@
 #ifndef MICROSUI_H
 #define MICROSUI_H
 
+#include "microsui_config.h"
 #include "sign.h"
+#include "verify.h"
 #include "utils.h"
 #include "cryptography.h"
+#include "bcs.h"
+#include "engine.h"
 
-#include "compact25519/compact_ed25519.c"
-#include "compact25519/compact_x25519.c"
-#include "compact25519/compact_wipe.c"
-#include "compact25519/c25519/c25519.c"
-#include "compact25519/c25519/ed25519.c"
-#include "compact25519/c25519/edsign.c"
-#include "compact25519/c25519/f25519.c"
-#include "compact25519/c25519/fprime.c"
-#include "compact25519/c25519/sha512.c"
-#include "monocypher/monocypher.c"
+#include "compact25519/compact_ed25519.h"
+#include "compact25519/compact_x25519.h"
+#include "compact25519/compact_wipe.h"
+#include "monocypher/monocypher.h"
 
 
 #endif
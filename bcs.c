@@ -0,0 +1,698 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "bcs.h"
+
+// Written bytes are handed to the sign context in runs of whole BLAKE2b
+// blocks, so the hash keeps pace with the writer without a call per field
+#define BCS_HASH_BLOCK 128
+
+// Variant indices of the Sui enums (commands are microsui_command_kind_t)
+#define TX_DATA_V1              0
+#define TX_KIND_PROGRAMMABLE    0
+#define CALL_ARG_PURE           0
+#define CALL_ARG_OBJECT         1
+#define OBJECT_ARG_OWNED        0
+#define OBJECT_ARG_SHARED       1
+#define OBJECT_ARG_RECEIVING    2
+#define EXPIRATION_NONE         0
+#define EXPIRATION_EPOCH        1
+
+static void bcs_hash(microsui_bcs_writer_t* w, int all) {
+    size_t n = w->len - w->hashed;
+    if (!all) n -= n % BCS_HASH_BLOCK;
+    if (n == 0) return;
+    if (w->sign) microsui_sign_update(w->sign, w->buf + w->hashed, n);
+    w->hashed += n;
+}
+
+// Room for n more bytes, or NULL (and the sticky overflow) if the arena is full
+static uint8_t* bcs_reserve(microsui_bcs_writer_t* w, size_t n) {
+    uint8_t* p;
+    if (w->overflow || w->cap - w->len < n) {
+        w->overflow = 1;
+        return NULL;
+    }
+    p = w->buf + w->len;
+    w->len += n;
+    return p;
+}
+
+static size_t bcs_uleb_encode(uint8_t out[10], uint64_t v) {
+    size_t n = 0;
+    do {
+        out[n] = (uint8_t)(v & 0x7f);
+        v >>= 7;
+        if (v) out[n] |= 0x80;
+        n++;
+    } while (v);
+    return n;
+}
+
+static int bcs_written(microsui_bcs_writer_t* w) {
+    if (w->len - w->hashed >= BCS_HASH_BLOCK) bcs_hash(w, 0);
+    return w->overflow ? -1 : 0;
+}
+
+void microsui_bcs_init(microsui_bcs_writer_t* w, uint8_t* arena, size_t arena_size, microsui_sign_ctx_t* sign) {
+    w->buf = arena;
+    w->cap = arena_size;
+    w->len = 0;
+    w->hashed = 0;
+    w->sign = sign;
+    w->overflow = 0;
+}
+
+int microsui_bcs_finish(microsui_bcs_writer_t* w) {
+    if (w->overflow) return -1;
+    bcs_hash(w, 1);
+    return 0;
+}
+
+int microsui_bcs_u8(microsui_bcs_writer_t* w, uint8_t v) {
+    uint8_t* p = bcs_reserve(w, 1);
+    if (p) p[0] = v;
+    return bcs_written(w);
+}
+
+int microsui_bcs_u16(microsui_bcs_writer_t* w, uint16_t v) {
+    uint8_t* p = bcs_reserve(w, 2);
+    if (p) {
+        p[0] = (uint8_t)v;
+        p[1] = (uint8_t)(v >> 8);
+    }
+    return bcs_written(w);
+}
+
+int microsui_bcs_u32(microsui_bcs_writer_t* w, uint32_t v) {
+    uint8_t* p = bcs_reserve(w, 4);
+    if (p) {
+        for (int i = 0; i < 4; i++) p[i] = (uint8_t)(v >> (8 * i));
+    }
+    return bcs_written(w);
+}
+
+int microsui_bcs_u64(microsui_bcs_writer_t* w, uint64_t v) {
+    uint8_t* p = bcs_reserve(w, 8);
+    if (p) {
+        for (int i = 0; i < 8; i++) p[i] = (uint8_t)(v >> (8 * i));
+    }
+    return bcs_written(w);
+}
+
+int microsui_bcs_bool(microsui_bcs_writer_t* w, int v) {
+    return microsui_bcs_u8(w, v ? 1 : 0);
+}
+
+int microsui_bcs_uleb128(microsui_bcs_writer_t* w, uint64_t v) {
+    uint8_t tmp[10];
+    return microsui_bcs_raw(w, tmp, bcs_uleb_encode(tmp, v));
+}
+
+int microsui_bcs_raw(microsui_bcs_writer_t* w, const uint8_t* data, size_t len) {
+    uint8_t* p = bcs_reserve(w, len);
+    if (p && len) memcpy(p, data, len);
+    return bcs_written(w);
+}
+
+int microsui_bcs_bytes(microsui_bcs_writer_t* w, const uint8_t* data, size_t len) {
+    microsui_bcs_uleb128(w, len);
+    return microsui_bcs_raw(w, data, len);
+}
+
+int microsui_bcs_string(microsui_bcs_writer_t* w, const char* s) {
+    return microsui_bcs_bytes(w, (const uint8_t*)s, strlen(s));
+}
+
+int microsui_bcs_address(microsui_bcs_writer_t* w, const uint8_t address[32]) {
+    return microsui_bcs_raw(w, address, 32);
+}
+
+int microsui_bcs_object_ref(microsui_bcs_writer_t* w, const microsui_object_ref_t* ref) {
+    microsui_bcs_raw(w, ref->id, 32);
+    microsui_bcs_u64(w, ref->version);
+    return microsui_bcs_bytes(w, ref->digest, 32);  // ObjectDigest is a vector<u8>
+}
+
+int microsui_bcs_arg(microsui_bcs_writer_t* w, microsui_arg_t arg) {
+    microsui_bcs_u8(w, (uint8_t)arg.kind);
+    if (arg.kind == MICROSUI_ARG_GAS_COIN) return bcs_written(w);
+    microsui_bcs_u16(w, arg.index);
+    if (arg.kind == MICROSUI_ARG_NESTED_RESULT) microsui_bcs_u16(w, arg.nested);
+    return bcs_written(w);
+}
+
+static int bcs_args(microsui_bcs_writer_t* w, const microsui_arg_t* args, size_t n) {
+    microsui_bcs_uleb128(w, n);
+    for (size_t i = 0; i < n; i++) microsui_bcs_arg(w, args[i]);
+    return bcs_written(w);
+}
+
+int microsui_bcs_tx_begin(microsui_bcs_writer_t* w) {
+    microsui_bcs_u8(w, TX_DATA_V1);
+    return microsui_bcs_u8(w, TX_KIND_PROGRAMMABLE);
+}
+
+int microsui_bcs_inputs(microsui_bcs_writer_t* w, size_t count) {
+    return microsui_bcs_uleb128(w, count);
+}
+
+int microsui_bcs_input_pure(microsui_bcs_writer_t* w, const uint8_t* bcs_value, size_t len) {
+    microsui_bcs_u8(w, CALL_ARG_PURE);
+    return microsui_bcs_bytes(w, bcs_value, len);
+}
+
+int microsui_bcs_input_u64(microsui_bcs_writer_t* w, uint64_t v) {
+    microsui_bcs_u8(w, CALL_ARG_PURE);
+    microsui_bcs_u8(w, 8);
+    return microsui_bcs_u64(w, v);
+}
+
+int microsui_bcs_input_address(microsui_bcs_writer_t* w, const uint8_t address[32]) {
+    microsui_bcs_u8(w, CALL_ARG_PURE);
+    microsui_bcs_u8(w, 32);
+    return microsui_bcs_address(w, address);
+}
+
+int microsui_bcs_input_object(microsui_bcs_writer_t* w, const microsui_object_ref_t* ref) {
+    microsui_bcs_u8(w, CALL_ARG_OBJECT);
+    microsui_bcs_u8(w, OBJECT_ARG_OWNED);
+    return microsui_bcs_object_ref(w, ref);
+}
+
+int microsui_bcs_input_shared(microsui_bcs_writer_t* w, const uint8_t id[32], uint64_t initial_shared_version,
+                              int mutable_ref) {
+    microsui_bcs_u8(w, CALL_ARG_OBJECT);
+    microsui_bcs_u8(w, OBJECT_ARG_SHARED);
+    microsui_bcs_raw(w, id, 32);
+    microsui_bcs_u64(w, initial_shared_version);
+    return microsui_bcs_bool(w, mutable_ref);
+}
+
+int microsui_bcs_input_receiving(microsui_bcs_writer_t* w, const microsui_object_ref_t* ref) {
+    microsui_bcs_u8(w, CALL_ARG_OBJECT);
+    microsui_bcs_u8(w, OBJECT_ARG_RECEIVING);
+    return microsui_bcs_object_ref(w, ref);
+}
+
+int microsui_bcs_commands(microsui_bcs_writer_t* w, size_t count) {
+    return microsui_bcs_uleb128(w, count);
+}
+
+int microsui_bcs_transfer_objects(microsui_bcs_writer_t* w, const microsui_arg_t* objects, size_t n,
+                                  microsui_arg_t address) {
+    microsui_bcs_u8(w, MICROSUI_COMMAND_TRANSFER_OBJECTS);
+    bcs_args(w, objects, n);
+    return microsui_bcs_arg(w, address);
+}
+
+int microsui_bcs_split_coins(microsui_bcs_writer_t* w, microsui_arg_t coin, const microsui_arg_t* amounts, size_t n) {
+    microsui_bcs_u8(w, MICROSUI_COMMAND_SPLIT_COINS);
+    microsui_bcs_arg(w, coin);
+    return bcs_args(w, amounts, n);
+}
+
+int microsui_bcs_merge_coins(microsui_bcs_writer_t* w, microsui_arg_t destination, const microsui_arg_t* sources,
+                             size_t n) {
+    microsui_bcs_u8(w, MICROSUI_COMMAND_MERGE_COINS);
+    microsui_bcs_arg(w, destination);
+    return bcs_args(w, sources, n);
+}
+
+int microsui_bcs_move_call(microsui_bcs_writer_t* w, const uint8_t package[32], const char* module,
+                           const char* function, const uint8_t* type_args, size_t type_args_size,
+                           size_t type_arg_count, const microsui_arg_t* args, size_t n) {
+    microsui_bcs_u8(w, MICROSUI_COMMAND_MOVE_CALL);
+    microsui_bcs_raw(w, package, 32);
+    microsui_bcs_string(w, module);
+    microsui_bcs_string(w, function);
+    microsui_bcs_uleb128(w, type_arg_count);
+    microsui_bcs_raw(w, type_args, type_args_size);
+    return bcs_args(w, args, n);
+}
+
+int microsui_bcs_make_move_vec(microsui_bcs_writer_t* w, const uint8_t* type_tag, size_t type_tag_size,
+                               const microsui_arg_t* elements, size_t n) {
+    microsui_bcs_u8(w, MICROSUI_COMMAND_MAKE_MOVE_VEC);
+    // Option<TypeTag>
+    if (type_tag) {
+        microsui_bcs_u8(w, 1);
+        microsui_bcs_raw(w, type_tag, type_tag_size);
+    } else {
+        microsui_bcs_u8(w, 0);
+    }
+    return bcs_args(w, elements, n);
+}
+
+int microsui_bcs_tx_end(microsui_bcs_writer_t* w, const uint8_t sender[32], const microsui_gas_data_t* gas,
+                        uint64_t expiration_epoch) {
+    // 1. Sender
+    microsui_bcs_address(w, sender);
+
+    // 2. GasData: payment coins, owner, price, budget
+    microsui_bcs_uleb128(w, gas->payment_count);
+    for (size_t i = 0; i < gas->payment_count; i++) microsui_bcs_object_ref(w, &gas->payment[i]);
+    microsui_bcs_address(w, gas->owner);
+    microsui_bcs_u64(w, gas->price);
+    microsui_bcs_u64(w, gas->budget);
+
+    // 3. TransactionExpiration
+    if (expiration_epoch == MICROSUI_BCS_NO_EXPIRATION) return microsui_bcs_u8(w, EXPIRATION_NONE);
+    microsui_bcs_u8(w, EXPIRATION_EPOCH);
+    return microsui_bcs_u64(w, expiration_epoch);
+}
+
+// Reading TransactionData in place
+
+#define OBJECT_REF_SIZE (32 + 8 + 1 + 32)
+
+// Bounds-checked cursor. The first read past the end sets err, and every
+// read after it returns zeros, so callers check err once at the end.
+typedef struct {
+    const uint8_t* p;
+    const uint8_t* end;
+    int err;
+} bcs_reader_t;
+
+static const uint8_t* rd_take(bcs_reader_t* r, size_t n) {
+    const uint8_t* p;
+    if (r->err || (size_t)(r->end - r->p) < n) {
+        r->err = 1;
+        return NULL;
+    }
+    p = r->p;
+    r->p += n;
+    return p;
+}
+
+static uint64_t rd_le(bcs_reader_t* r, int n) {
+    const uint8_t* p = rd_take(r, (size_t)n);
+    uint64_t v = 0;
+    if (!p) return 0;
+    for (int i = n - 1; i >= 0; i--) v = (v << 8) | p[i];
+    return v;
+}
+
+// Sequence lengths and enum variants: canonical ULEB128 of at most 32 bits
+static size_t rd_uleb(bcs_reader_t* r) {
+    uint64_t v = 0;
+    for (int shift = 0; shift < 35; shift += 7) {
+        const uint8_t* p = rd_take(r, 1);
+        if (!p) return 0;
+        v |= (uint64_t)(p[0] & 0x7f) << shift;
+        if (!(p[0] & 0x80)) {
+            if ((p[0] == 0 && shift > 0) || v > UINT32_MAX) break;
+            return (size_t)v;
+        }
+    }
+    r->err = 1;
+    return 0;
+}
+
+// A vector length, rejected outright when its elements of at least
+// min_size bytes each cannot fit in what is left
+static size_t rd_count(bcs_reader_t* r, size_t min_size) {
+    size_t n = rd_uleb(r);
+    if (!r->err && n > (size_t)(r->end - r->p) / min_size) r->err = 1;
+    return r->err ? 0 : n;
+}
+
+static const uint8_t* rd_bytes(bcs_reader_t* r, size_t* len) {
+    *len = rd_uleb(r);
+    return rd_take(r, *len);
+}
+
+static void rd_arg(bcs_reader_t* r, microsui_arg_t* arg) {
+    uint8_t kind = (uint8_t)rd_le(r, 1);
+    arg->kind = (microsui_arg_kind_t)kind;
+    arg->index = 0;
+    arg->nested = 0;
+    if (kind > MICROSUI_ARG_NESTED_RESULT) r->err = 1;
+    if (kind == MICROSUI_ARG_GAS_COIN) return;
+    arg->index = (uint16_t)rd_le(r, 2);
+    if (kind == MICROSUI_ARG_NESTED_RESULT) arg->nested = (uint16_t)rd_le(r, 2);
+}
+
+static void rd_args(bcs_reader_t* r, microsui_arg_list_t* args) {
+    microsui_arg_t arg;
+    args->count = rd_count(r, 1);
+    args->data = r->p;
+    for (size_t i = 0; i < args->count && !r->err; i++) rd_arg(r, &arg);
+}
+
+static void rd_object_ref(bcs_reader_t* r, microsui_object_ref_view_t* ref) {
+    ref->id = rd_take(r, 32);
+    ref->version = rd_le(r, 8);
+    if (rd_uleb(r) != 32) r->err = 1;
+    ref->digest = rd_take(r, 32);
+}
+
+// Skips n TypeTags. Vector and struct tags nest further tags, which are
+// counted instead of recursed into, so the stack stays flat however deep
+// the types go.
+static void rd_type_tags(bcs_reader_t* r, size_t n) {
+    size_t pending = n;
+    size_t len;
+    while (pending > 0 && !r->err) {
+        uint8_t tag = (uint8_t)rd_le(r, 1);
+        pending--;
+        if (tag == 6) {             // vector<T>
+            pending++;
+        } else if (tag == 7) {      // struct: address, module, name, type parameters
+            rd_take(r, 32);
+            rd_bytes(r, &len);
+            rd_bytes(r, &len);
+            pending += rd_count(r, 1);
+        } else if (tag > 10) {
+            r->err = 1;
+        }
+        // every pending tag takes at least one byte
+        if (pending > (size_t)(r->end - r->p)) r->err = 1;
+    }
+}
+
+static void rd_input(bcs_reader_t* r, microsui_input_view_t* input) {
+    size_t variant = rd_uleb(r);
+    memset(input, 0, sizeof(*input));
+    if (variant == CALL_ARG_PURE) {
+        input->kind = MICROSUI_INPUT_PURE;
+        input->data = rd_bytes(r, &input->data_len);
+        return;
+    }
+    if (variant != CALL_ARG_OBJECT) {
+        r->err = 1;
+        return;
+    }
+    switch (rd_uleb(r)) {
+    case OBJECT_ARG_OWNED:
+        input->kind = MICROSUI_INPUT_OWNED;
+        rd_object_ref(r, &input->object);
+        break;
+    case OBJECT_ARG_SHARED:
+        input->kind = MICROSUI_INPUT_SHARED;
+        input->object.id = rd_take(r, 32);
+        input->object.version = rd_le(r, 8);
+        input->mutable_ref = (int)rd_le(r, 1);
+        if (input->mutable_ref > 1) r->err = 1;
+        break;
+    case OBJECT_ARG_RECEIVING:
+        input->kind = MICROSUI_INPUT_RECEIVING;
+        rd_object_ref(r, &input->object);
+        break;
+    default:
+        r->err = 1;
+    }
+}
+
+static void rd_command(bcs_reader_t* r, microsui_command_view_t* command) {
+    const uint8_t* start;
+    size_t n, len;
+
+    memset(command, 0, sizeof(*command));
+    command->kind = (microsui_command_kind_t)rd_uleb(r);
+    switch (command->kind) {
+    case MICROSUI_COMMAND_MOVE_CALL:
+        command->package = rd_take(r, 32);
+        command->module = (const char*)rd_bytes(r, &command->module_len);
+        command->function = (const char*)rd_bytes(r, &command->function_len);
+        command->type_arg_count = rd_count(r, 1);
+        start = r->p;
+        rd_type_tags(r, command->type_arg_count);
+        command->type_args = start;
+        command->type_args_size = (size_t)(r->p - start);
+        rd_args(r, &command->args);
+        break;
+    case MICROSUI_COMMAND_TRANSFER_OBJECTS:
+        rd_args(r, &command->args);
+        rd_arg(r, &command->arg);
+        break;
+    case MICROSUI_COMMAND_SPLIT_COINS:
+    case MICROSUI_COMMAND_MERGE_COINS:
+        rd_arg(r, &command->arg);
+        rd_args(r, &command->args);
+        break;
+    case MICROSUI_COMMAND_MAKE_MOVE_VEC:
+        n = (size_t)rd_le(r, 1);  // Option<TypeTag>
+        if (n > 1) r->err = 1;
+        start = r->p;
+        rd_type_tags(r, n);
+        command->type_args = start;
+        command->type_args_size = (size_t)(r->p - start);
+        command->type_arg_count = n;
+        rd_args(r, &command->args);
+        break;
+    case MICROSUI_COMMAND_PUBLISH:
+    case MICROSUI_COMMAND_UPGRADE:
+        // modules, then dependencies
+        n = rd_count(r, 1);
+        for (size_t i = 0; i < n && !r->err; i++) rd_bytes(r, &len);
+        rd_take(r, rd_count(r, 32) * 32);
+        if (command->kind == MICROSUI_COMMAND_UPGRADE) {
+            command->package = rd_take(r, 32);
+            rd_arg(r, &command->arg);
+        }
+        break;
+    default:
+        r->err = 1;
+    }
+}
+
+static bcs_reader_t rd_at(const microsui_tx_view_t* v, size_t offset) {
+    bcs_reader_t r = { v->tx + offset, v->tx + v->len, 0 };
+    return r;
+}
+
+int microsui_tx_view_init(microsui_tx_view_t* v, const uint8_t* tx, size_t len) {
+    bcs_reader_t r = { tx, tx + len, 0 };
+    microsui_input_view_t input;
+    microsui_command_view_t command;
+    size_t i;
+
+    memset(v, 0, sizeof(*v));
+    v->tx = tx;
+    v->len = len;
+
+    // 1. TransactionData::V1, TransactionKind::ProgrammableTransaction
+    if (rd_uleb(&r) != TX_DATA_V1 || rd_uleb(&r) != TX_KIND_PROGRAMMABLE) return -1;
+
+    // 2. Inputs and commands
+    v->input_count = rd_count(&r, 1);
+    v->inputs = (size_t)(r.p - tx);
+    for (i = 0; i < v->input_count && !r.err; i++) rd_input(&r, &input);
+    v->command_count = rd_count(&r, 1);
+    v->commands = (size_t)(r.p - tx);
+    for (i = 0; i < v->command_count && !r.err; i++) rd_command(&r, &command);
+
+    // 3. Sender and GasData
+    v->sender = (size_t)(r.p - tx);
+    rd_take(&r, 32);
+    v->payment_count = rd_count(&r, OBJECT_REF_SIZE);
+    v->payment = (size_t)(r.p - tx);
+    for (i = 0; i < v->payment_count && !r.err; i++) {
+        microsui_object_ref_view_t ref;
+        rd_object_ref(&r, &ref);
+    }
+    v->gas_owner = (size_t)(r.p - tx);
+    rd_take(&r, 32 + 8 + 8);
+
+    // 4. TransactionExpiration, and nothing after it
+    v->expiration = (size_t)(r.p - tx);
+    switch (rd_uleb(&r)) {
+    case EXPIRATION_NONE:
+        break;
+    case EXPIRATION_EPOCH:
+        rd_take(&r, 8);
+        break;
+    default:
+        r.err = 1;
+    }
+    if (r.err || r.p != r.end) return -1;
+    return 0;
+}
+
+const uint8_t* microsui_tx_view_sender(const microsui_tx_view_t* v) {
+    return v->tx + v->sender;
+}
+
+const uint8_t* microsui_tx_view_gas_owner(const microsui_tx_view_t* v) {
+    return v->tx + v->gas_owner;
+}
+
+uint64_t microsui_tx_view_gas_price(const microsui_tx_view_t* v) {
+    bcs_reader_t r = rd_at(v, v->gas_owner + 32);
+    return rd_le(&r, 8);
+}
+
+uint64_t microsui_tx_view_gas_budget(const microsui_tx_view_t* v) {
+    bcs_reader_t r = rd_at(v, v->gas_owner + 40);
+    return rd_le(&r, 8);
+}
+
+uint64_t microsui_tx_view_expiration(const microsui_tx_view_t* v) {
+    bcs_reader_t r = rd_at(v, v->expiration);
+    if (rd_uleb(&r) != EXPIRATION_EPOCH) return MICROSUI_BCS_NO_EXPIRATION;
+    return rd_le(&r, 8);
+}
+
+int microsui_tx_view_gas_payment(const microsui_tx_view_t* v, size_t i, microsui_object_ref_view_t* ref) {
+    bcs_reader_t r;
+    if (i >= v->payment_count) return -1;
+    r = rd_at(v, v->payment + i * OBJECT_REF_SIZE);
+    rd_object_ref(&r, ref);
+    return 0;
+}
+
+int microsui_tx_view_input(const microsui_tx_view_t* v, size_t i, microsui_input_view_t* input) {
+    bcs_reader_t r;
+    if (i >= v->input_count) return -1;
+    r = rd_at(v, v->inputs);
+    for (size_t k = 0; k <= i; k++) rd_input(&r, input);
+    return 0;
+}
+
+int microsui_tx_view_command(const microsui_tx_view_t* v, size_t i, microsui_command_view_t* command) {
+    bcs_reader_t r;
+    if (i >= v->command_count) return -1;
+    r = rd_at(v, v->commands);
+    for (size_t k = 0; k <= i; k++) rd_command(&r, command);
+    return 0;
+}
+
+int microsui_tx_view_arg(const microsui_arg_list_t* args, size_t i, microsui_arg_t* arg) {
+    // The list was checked by microsui_tx_view_init(); each argument is at
+    // most 5 bytes
+    bcs_reader_t r = { args->data, args->data + 5 * args->count, 0 };
+    if (i >= args->count) return -1;
+    for (size_t k = 0; k <= i; k++) rd_arg(&r, arg);
+    return 0;
+}
+
+static int view_pure_input(const microsui_tx_view_t* v, microsui_arg_t arg, size_t size, const uint8_t** data) {
+    microsui_input_view_t input;
+    if (arg.kind != MICROSUI_ARG_INPUT) return -1;
+    if (microsui_tx_view_input(v, arg.index, &input) != 0) return -1;
+    if (input.kind != MICROSUI_INPUT_PURE || input.data_len != size) return -1;
+    *data = input.data;
+    return 0;
+}
+
+int microsui_tx_view_input_u64(const microsui_tx_view_t* v, microsui_arg_t arg, uint64_t* value) {
+    const uint8_t* data;
+    bcs_reader_t r;
+    if (view_pure_input(v, arg, 8, &data) != 0) return -1;
+    r.p = data;
+    r.end = data + 8;
+    r.err = 0;
+    *value = rd_le(&r, 8);
+    return 0;
+}
+
+int microsui_tx_view_input_address(const microsui_tx_view_t* v, microsui_arg_t arg, const uint8_t** address) {
+    return view_pure_input(v, arg, 32, address);
+}
+
+// Transaction templates
+
+static int template_add(microsui_tx_template_t* t, size_t offset, size_t size) {
+    if (t->field_count == MICROSUI_TEMPLATE_MAX_FIELDS) return -1;
+    t->offset[t->field_count] = offset;
+    t->size[t->field_count] = size;
+    return (int)t->field_count++;
+}
+
+static int template_view(const microsui_tx_template_t* t, microsui_tx_view_t* v) {
+    return microsui_tx_view_init(v, t->tx, t->len);
+}
+
+int microsui_tx_template_init(microsui_tx_template_t* t, uint8_t* tx, size_t len, size_t cap) {
+    microsui_tx_view_t v;
+    t->tx = tx;
+    t->len = len;
+    t->cap = cap;
+    t->field_count = 0;
+    if (len > cap) return -1;
+    return template_view(t, &v);
+}
+
+static int template_pure_input(microsui_tx_template_t* t, size_t i, microsui_input_view_t* input) {
+    microsui_tx_view_t v;
+    if (template_view(t, &v) != 0 || microsui_tx_view_input(&v, i, input) != 0) return -1;
+    return input->kind == MICROSUI_INPUT_PURE ? 0 : -1;
+}
+
+int microsui_tx_template_input(microsui_tx_template_t* t, size_t i) {
+    microsui_input_view_t input;
+    if (template_pure_input(t, i, &input) != 0 || input.data_len == 0) return -1;
+    return template_add(t, (size_t)(input.data - t->tx), input.data_len);
+}
+
+int microsui_tx_template_input_bytes(microsui_tx_template_t* t, size_t i) {
+    microsui_input_view_t input;
+    uint8_t prefix[10];
+    if (template_pure_input(t, i, &input) != 0) return -1;
+    // The view points at the value; the field starts at its length prefix
+    return template_add(t, (size_t)(input.data - t->tx) - bcs_uleb_encode(prefix, input.data_len), 0);
+}
+
+int microsui_tx_template_gas_version(microsui_tx_template_t* t, size_t i) {
+    microsui_tx_view_t v;
+    microsui_object_ref_view_t ref;
+    if (template_view(t, &v) != 0 || microsui_tx_view_gas_payment(&v, i, &ref) != 0) return -1;
+    return template_add(t, (size_t)(ref.id - t->tx) + 32, 8);
+}
+
+int microsui_tx_template_gas_digest(microsui_tx_template_t* t, size_t i) {
+    microsui_tx_view_t v;
+    microsui_object_ref_view_t ref;
+    if (template_view(t, &v) != 0 || microsui_tx_view_gas_payment(&v, i, &ref) != 0) return -1;
+    return template_add(t, (size_t)(ref.digest - t->tx), 32);
+}
+
+int microsui_tx_template_field(microsui_tx_template_t* t, size_t offset, size_t size) {
+    if (size == 0 || offset > t->len || size > t->len - offset) return -1;
+    return template_add(t, offset, size);
+}
+
+// Replaces the pure input at offset with a vector<u8> of len bytes
+static int template_set_pure(microsui_tx_template_t* t, size_t offset, const uint8_t* value, size_t len) {
+    bcs_reader_t r = { t->tx + offset, t->tx + t->len, 0 };
+    uint8_t prefix[10];
+    size_t old_prefix, old_end, new_prefix, new_end;
+
+    // 1. Old and new extent of the field
+    size_t old_len = rd_uleb(&r);
+    if (r.err || len > UINT32_MAX) return -1;
+    old_prefix = (size_t)(r.p - (t->tx + offset));
+    if (old_len > t->len - offset - old_prefix) return -1;
+    old_end = offset + old_prefix + old_len;
+    new_prefix = bcs_uleb_encode(prefix, len);
+    new_end = offset + new_prefix + len;
+
+    // 2. Same extent: the value is copied in place. Otherwise the rest of
+    //    the transaction moves, and the fields in it with it.
+    if (new_end != old_end) {
+        if (new_end > old_end && new_end - old_end > t->cap - t->len) return -1;
+        memmove(t->tx + new_end, t->tx + old_end, t->len - old_end);
+        t->len = t->len - old_end + new_end;
+        for (size_t f = 0; f < t->field_count; f++) {
+            if (t->offset[f] > offset) t->offset[f] = t->offset[f] - old_end + new_end;
+        }
+    }
+    if (len != old_len) memcpy(t->tx + offset, prefix, new_prefix);
+    if (len) memcpy(t->tx + offset + new_prefix, value, len);
+    return 0;
+}
+
+int microsui_tx_template_set(microsui_tx_template_t* t, int field, const uint8_t* value, size_t len) {
+    if (field < 0 || (size_t)field >= t->field_count) return -1;
+    if (t->size[field] == 0) return template_set_pure(t, t->offset[field], value, len);
+    if (len != t->size[field]) return -1;
+    memcpy(t->tx + t->offset[field], value, len);
+    return 0;
+}
+
+int microsui_tx_template_set_u64(microsui_tx_template_t* t, int field, uint64_t value) {
+    uint8_t le[8];
+    for (int i = 0; i < 8; i++) le[i] = (uint8_t)(value >> (8 * i));
+    return microsui_tx_template_set(t, field, le, 8);
+}
@@ -0,0 +1,273 @@
+#ifndef BCS_H
+#define BCS_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "microsui_config.h"
+#include "sign.h"
+
+// BCS writer for Sui TransactionData. Bytes are serialized into an arena
+// owned by the caller and, when the writer has a sign context, fed to its
+// BLAKE2b intent hash block by block as they are written. Building and
+// signing is then one pass:
+//
+//     microsui_sign_init(&ctx);
+//     microsui_bcs_init(&w, arena, sizeof(arena), &ctx);
+//     microsui_bcs_tx_begin(&w);
+//     ... inputs and commands ...
+//     microsui_bcs_tx_end(&w, sender, &gas, MICROSUI_BCS_NO_EXPIRATION);
+//     if (microsui_bcs_finish(&w) == 0) microsui_sign_final(&ctx, &signer, sig);
+//
+// The transaction bytes stay in arena[0 .. w.len) for submission. BCS puts
+// the length of a vector before its elements, so vectors of inputs, commands
+// and gas coins take their count up front. Every function returns 0, or -1
+// once the arena has overflowed; the error sticks until microsui_bcs_finish().
+//
+// The view (microsui_tx_view_*) reads serialized TransactionData in place,
+// for example to check a transaction's sender, budget, recipients and amounts
+// before signing the same bytes with microsui_sign_tx_bytes(). It copies
+// nothing and allocates nothing: microsui_tx_view_init() checks the whole
+// transaction once and records where its sections start, and the accessors
+// decode single fields on demand, returning pointers into the bytes.
+//
+// A template (microsui_tx_template_*) is a transaction kept in its buffer
+// with the offsets of the fields that change between sends, such as the
+// amount, the recipient and the gas coin's version and digest. Patching
+// those fields is a copy into place, after which the buffer is signed as
+// is with microsui_signer_sign_tx_bytes():
+//
+//     microsui_tx_template_init(&t, arena, w.len, sizeof(arena));
+//     amount = microsui_tx_template_input(&t, 0);
+//     version = microsui_tx_template_gas_version(&t, 0);
+//     ...
+//     microsui_tx_template_set_u64(&t, amount, 2500000);
+//     microsui_tx_template_set_u64(&t, version, new_version);
+//     microsui_signer_sign_tx_bytes(&signer, sig, t.tx, t.len);
+
+typedef struct {
+    uint8_t* buf;
+    size_t cap;
+    size_t len;                 // bytes written so far
+    size_t hashed;              // bytes already fed to the sign context
+    microsui_sign_ctx_t* sign;  // optional
+    int overflow;
+} microsui_bcs_writer_t;
+
+// Reference to an owned object version: ObjectID, SequenceNumber, ObjectDigest
+typedef struct {
+    uint8_t id[32];
+    uint64_t version;
+    uint8_t digest[32];
+} microsui_object_ref_t;
+
+// Argument of a programmable transaction command
+typedef enum {
+    MICROSUI_ARG_GAS_COIN = 0,
+    MICROSUI_ARG_INPUT = 1,
+    MICROSUI_ARG_RESULT = 2,
+    MICROSUI_ARG_NESTED_RESULT = 3,
+} microsui_arg_kind_t;
+
+typedef struct {
+    microsui_arg_kind_t kind;
+    uint16_t index;   // input or command index
+    uint16_t nested;  // result index, NESTED_RESULT only
+} microsui_arg_t;
+
+typedef struct {
+    const microsui_object_ref_t* payment;
+    size_t payment_count;
+    uint8_t owner[32];
+    uint64_t price;
+    uint64_t budget;
+} microsui_gas_data_t;
+
+#define MICROSUI_BCS_NO_EXPIRATION UINT64_MAX
+
+void microsui_bcs_init(microsui_bcs_writer_t* w, uint8_t* arena, size_t arena_size, microsui_sign_ctx_t* sign);
+
+// Feeds the rest of the bytes to the sign context. Returns 0, or -1 if the
+// arena overflowed, in which case the transaction must not be signed.
+int microsui_bcs_finish(microsui_bcs_writer_t* w);
+
+// Primitives
+int microsui_bcs_u8(microsui_bcs_writer_t* w, uint8_t v);
+int microsui_bcs_u16(microsui_bcs_writer_t* w, uint16_t v);
+int microsui_bcs_u32(microsui_bcs_writer_t* w, uint32_t v);
+int microsui_bcs_u64(microsui_bcs_writer_t* w, uint64_t v);
+int microsui_bcs_bool(microsui_bcs_writer_t* w, int v);
+int microsui_bcs_uleb128(microsui_bcs_writer_t* w, uint64_t v);
+int microsui_bcs_raw(microsui_bcs_writer_t* w, const uint8_t* data, size_t len);      // no length prefix
+int microsui_bcs_bytes(microsui_bcs_writer_t* w, const uint8_t* data, size_t len);    // vector<u8>
+int microsui_bcs_string(microsui_bcs_writer_t* w, const char* s);                     // String, Identifier
+int microsui_bcs_address(microsui_bcs_writer_t* w, const uint8_t address[32]);
+int microsui_bcs_object_ref(microsui_bcs_writer_t* w, const microsui_object_ref_t* ref);
+int microsui_bcs_arg(microsui_bcs_writer_t* w, microsui_arg_t arg);
+
+// TransactionData::V1 of kind ProgrammableTransaction
+int microsui_bcs_tx_begin(microsui_bcs_writer_t* w);
+
+// Inputs (CallArg): the count, then that many inputs
+int microsui_bcs_inputs(microsui_bcs_writer_t* w, size_t count);
+int microsui_bcs_input_pure(microsui_bcs_writer_t* w, const uint8_t* bcs_value, size_t len);
+int microsui_bcs_input_u64(microsui_bcs_writer_t* w, uint64_t v);
+int microsui_bcs_input_address(microsui_bcs_writer_t* w, const uint8_t address[32]);
+int microsui_bcs_input_object(microsui_bcs_writer_t* w, const microsui_object_ref_t* ref);
+int microsui_bcs_input_shared(microsui_bcs_writer_t* w, const uint8_t id[32], uint64_t initial_shared_version,
+                              int mutable_ref);
+int microsui_bcs_input_receiving(microsui_bcs_writer_t* w, const microsui_object_ref_t* ref);
+
+// Commands: the count, then that many commands
+int microsui_bcs_commands(microsui_bcs_writer_t* w, size_t count);
+int microsui_bcs_transfer_objects(microsui_bcs_writer_t* w, const microsui_arg_t* objects, size_t n,
+                                  microsui_arg_t address);
+int microsui_bcs_split_coins(microsui_bcs_writer_t* w, microsui_arg_t coin, const microsui_arg_t* amounts, size_t n);
+int microsui_bcs_merge_coins(microsui_bcs_writer_t* w, microsui_arg_t destination, const microsui_arg_t* sources,
+                             size_t n);
+// type_args holds type_arg_count BCS TypeTags back to back
+int microsui_bcs_move_call(microsui_bcs_writer_t* w, const uint8_t package[32], const char* module,
+                           const char* function, const uint8_t* type_args, size_t type_args_size,
+                           size_t type_arg_count, const microsui_arg_t* args, size_t n);
+// type_tag is a BCS TypeTag, or NULL to leave the element type out
+int microsui_bcs_make_move_vec(microsui_bcs_writer_t* w, const uint8_t* type_tag, size_t type_tag_size,
+                               const microsui_arg_t* elements, size_t n);
+
+// Sender, GasData and TransactionExpiration (an epoch, or MICROSUI_BCS_NO_EXPIRATION)
+int microsui_bcs_tx_end(microsui_bcs_writer_t* w, const uint8_t sender[32], const microsui_gas_data_t* gas,
+                        uint64_t expiration_epoch);
+
+// What microsui_tx_view_init() records. The counts can be read directly.
+typedef struct {
+    const uint8_t* tx;
+    size_t len;
+    size_t input_count;
+    size_t command_count;
+    size_t payment_count;
+    size_t inputs;      // offset of the first input
+    size_t commands;    // offset of the first command
+    size_t sender;      // offset of the sender
+    size_t payment;     // offset of the first gas coin
+    size_t gas_owner;   // offset of the gas owner, followed by price and budget
+    size_t expiration;  // offset of the TransactionExpiration
+} microsui_tx_view_t;
+
+// Object reference inside the transaction bytes
+typedef struct {
+    const uint8_t* id;
+    uint64_t version;
+    const uint8_t* digest;
+} microsui_object_ref_view_t;
+
+typedef enum {
+    MICROSUI_INPUT_PURE = 0,
+    MICROSUI_INPUT_OWNED = 1,
+    MICROSUI_INPUT_SHARED = 2,
+    MICROSUI_INPUT_RECEIVING = 3,
+} microsui_input_kind_t;
+
+typedef struct {
+    microsui_input_kind_t kind;
+    const uint8_t* data;                // PURE: the BCS value
+    size_t data_len;
+    microsui_object_ref_view_t object;  // OWNED, RECEIVING; SHARED: id and initial shared version only
+    int mutable_ref;                    // SHARED
+} microsui_input_view_t;
+
+typedef enum {
+    MICROSUI_COMMAND_MOVE_CALL = 0,
+    MICROSUI_COMMAND_TRANSFER_OBJECTS = 1,
+    MICROSUI_COMMAND_SPLIT_COINS = 2,
+    MICROSUI_COMMAND_MERGE_COINS = 3,
+    MICROSUI_COMMAND_PUBLISH = 4,
+    MICROSUI_COMMAND_MAKE_MOVE_VEC = 5,
+    MICROSUI_COMMAND_UPGRADE = 6,
+} microsui_command_kind_t;
+
+// Serialized vector of arguments, read with microsui_tx_view_arg()
+typedef struct {
+    const uint8_t* data;
+    size_t count;
+} microsui_arg_list_t;
+
+typedef struct {
+    microsui_command_kind_t kind;
+    microsui_arg_t arg;          // TRANSFER_OBJECTS: address, SPLIT_COINS: coin, MERGE_COINS: destination,
+                                 // UPGRADE: ticket
+    microsui_arg_list_t args;    // objects, amounts, sources, call arguments or vector elements
+    const uint8_t* package;      // MOVE_CALL; UPGRADE: the package upgraded
+    const char* module;          // MOVE_CALL, not null-terminated
+    size_t module_len;
+    const char* function;        // MOVE_CALL, not null-terminated
+    size_t function_len;
+    const uint8_t* type_args;    // MOVE_CALL: type_arg_count TypeTags back to back;
+    size_t type_args_size;       // MAKE_MOVE_VEC: the element type, if given
+    size_t type_arg_count;
+} microsui_command_view_t;
+
+// Checks that tx[0 .. len) is exactly one TransactionData::V1 of kind
+// ProgrammableTransaction. Returns 0, or -1 if it is malformed or of another
+// kind; the view must not be used then.
+int microsui_tx_view_init(microsui_tx_view_t* v, const uint8_t* tx, size_t len);
+
+const uint8_t* microsui_tx_view_sender(const microsui_tx_view_t* v);
+const uint8_t* microsui_tx_view_gas_owner(const microsui_tx_view_t* v);
+uint64_t microsui_tx_view_gas_price(const microsui_tx_view_t* v);
+uint64_t microsui_tx_view_gas_budget(const microsui_tx_view_t* v);
+// Epoch after which the transaction expires, or MICROSUI_BCS_NO_EXPIRATION
+uint64_t microsui_tx_view_expiration(const microsui_tx_view_t* v);
+
+// Gas coins are fixed size, so these are O(1). Inputs and commands are
+// walked from the first one, so they are O(i). Each returns 0, or -1 if i is
+// out of range.
+int microsui_tx_view_gas_payment(const microsui_tx_view_t* v, size_t i, microsui_object_ref_view_t* ref);
+int microsui_tx_view_input(const microsui_tx_view_t* v, size_t i, microsui_input_view_t* input);
+int microsui_tx_view_command(const microsui_tx_view_t* v, size_t i, microsui_command_view_t* command);
+int microsui_tx_view_arg(const microsui_arg_list_t* args, size_t i, microsui_arg_t* arg);
+
+// Value of a pure u64 or address input that arg points to, as passed to
+// SplitCoins or TransferObjects. Returns 0, or -1 if arg is not an input of
+// that size.
+int microsui_tx_view_input_u64(const microsui_tx_view_t* v, microsui_arg_t arg, uint64_t* value);
+int microsui_tx_view_input_address(const microsui_tx_view_t* v, microsui_arg_t arg, const uint8_t** address);
+
+typedef struct {
+    uint8_t* tx;
+    size_t len;
+    size_t cap;
+    size_t field_count;
+    size_t offset[MICROSUI_TEMPLATE_MAX_FIELDS];
+    size_t size[MICROSUI_TEMPLATE_MAX_FIELDS];  // 0 for a pure input of any length
+} microsui_tx_template_t;
+
+// Makes a template of the transaction in tx[0 .. len), in a buffer of cap
+// bytes; the room past len lets pure inputs grow. Returns 0, or -1 if the
+// transaction does not pass microsui_tx_view_init().
+int microsui_tx_template_init(microsui_tx_template_t* t, uint8_t* tx, size_t len, size_t cap);
+
+// Each of these records a field and returns its number, or -1 if it does not
+// exist or MICROSUI_TEMPLATE_MAX_FIELDS are already recorded.
+// The value of pure input i, fixed at its current length (8 bytes for a u64
+// amount, 32 for an address)
+int microsui_tx_template_input(microsui_tx_template_t* t, size_t i);
+// The value of pure input i as a vector<u8> of any length, for strings and
+// byte vectors
+int microsui_tx_template_input_bytes(microsui_tx_template_t* t, size_t i);
+// Version and digest of gas coin i
+int microsui_tx_template_gas_version(microsui_tx_template_t* t, size_t i);
+int microsui_tx_template_gas_digest(microsui_tx_template_t* t, size_t i);
+// size bytes at offset, for fields located by other means, e.g. with w.len
+// while the transaction was written. A field must not straddle a pure input
+// recorded with microsui_tx_template_input_bytes().
+int microsui_tx_template_field(microsui_tx_template_t* t, size_t offset, size_t size);
+
+// Writes value into field. A fixed-width field takes exactly its size. A
+// field from microsui_tx_template_input_bytes() takes any length: if it
+// changes, the ULEB128 prefix is rewritten and the rest of the transaction
+// moved, along with the offsets of the fields in it. Returns 0, or -1
+// (leaving the transaction unchanged) if the length does not fit the field
+// or the buffer.
+int microsui_tx_template_set(microsui_tx_template_t* t, int field, const uint8_t* value, size_t len);
+// The same with a u64, little-endian, as BCS stores amounts and versions
+int microsui_tx_template_set_u64(microsui_tx_template_t* t, int field, uint64_t value);
+
+#endif
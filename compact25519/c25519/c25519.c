@@ -25,12 +25,12 @@ static void xc_double(uint8_t *x3, uint8_t *z3,
 	uint8_t x1z1[F25519_SIZE];
 	uint8_t a[F25519_SIZE];
 
-	f25519_mul__distinct(x1sq, x1, x1);
-	f25519_mul__distinct(z1sq, z1, z1);
+	f25519_sqr(x1sq, x1);
+	f25519_sqr(z1sq, z1);
 	f25519_mul__distinct(x1z1, x1, z1);
 
 	f25519_sub(a, x1sq, z1sq);
-	f25519_mul__distinct(x3, a, a);
+	f25519_sqr(x3, a);
 
 	f25519_mul_c(a, x1z1, 486662);
 	f25519_add(a, x1sq, a);
@@ -73,11 +73,11 @@ static void xc_diffadd(uint8_t *x5, uint8_t *z5,
 	f25519_mul__distinct(cb, a, b);
 
 	f25519_add(a, da, cb);
-	f25519_mul__distinct(b, a, a);
+	f25519_sqr(b, a);
 	f25519_mul__distinct(x5, z1, b);
 
 	f25519_sub(a, da, cb);
-	f25519_mul__distinct(b, a, a);
+	f25519_sqr(b, a);
 	f25519_mul__distinct(z5, x1, b);
 }
 
@@ -119,7 +119,7 @@ uint8_t ed25519_try_unpack(uint8_t *x, uint8_t *y, const uint8_t *comp)
 	y[31] &= 127;
 
 	/* Compute c = y^2 */
-	f25519_mul__distinct(c, y, y);
+	f25519_sqr(c, y);
 
 	/* Compute b = (1+dy^2)^-1 */
 	f25519_mul__distinct(b, c, ed25519_d);
@@ -140,7 +140,7 @@ uint8_t ed25519_try_unpack(uint8_t *x, uint8_t *y, const uint8_t *comp)
 	f25519_select(x, a, b, (a[0] ^ parity) & 1);
 
 	/* Verify that x^2 = c */
-	f25519_mul__distinct(a, x, x);
+	f25519_sqr(a, x);
 	f25519_normalize(a);
 	f25519_normalize(c);
 
@@ -258,19 +258,19 @@ void ed25519_double(struct ed25519_pt *r, const struct ed25519_pt *p)
 	uint8_t h[F25519_SIZE];
 
 	/* A = X1^2 */
-	f25519_mul__distinct(a, p->x, p->x);
+	f25519_sqr(a, p->x);
 
 	/* B = Y1^2 */
-	f25519_mul__distinct(b, p->y, p->y);
+	f25519_sqr(b, p->y);
 
 	/* C = 2 Z1^2 */
-	f25519_mul__distinct(c, p->z, p->z);
+	f25519_sqr(c, p->z);
 	f25519_add(c, c, c);
 
 	/* D = a A (alter sign) */
 	/* E = (X1+Y1)^2-A-B */
 	f25519_add(f, p->x, p->y);
-	f25519_mul__distinct(e, f, f);
+	f25519_sqr(e, f);
 	f25519_sub(e, e, a);
 	f25519_sub(e, e, b);
 
@@ -320,4 +320,616 @@ void ed25519_smult(struct ed25519_pt *r_out, const struct ed25519_pt *p,
 
 	ed25519_copy(r_out, &r);
 }
+
+/* Recode e as a width-4 NAF: 256 digits, each zero or odd in [-7, 7],
+ * with nonzero digits at least four positions apart.
+ */
+static void wnaf_recode(int8_t *r, const uint8_t *e)
+{
+	int i;
+	int b;
+	int k;
+
+	for (i = 0; i < 256; i++)
+		r[i] = (e[i >> 3] >> (i & 7)) & 1;
+
+	for (i = 0; i < 256; i++) {
+		if (!r[i])
+			continue;
+
+		for (b = 1; b <= 3 && i + b < 256; b++) {
+			if (!r[i + b])
+				continue;
+
+			if (r[i] + (r[i + b] << b) <= 7) {
+				r[i] += r[i + b] << b;
+				r[i + b] = 0;
+			} else if (r[i] - (r[i + b] << b) >= -7) {
+				r[i] -= r[i + b] << b;
+
+				for (k = i + b; k < 256; k++) {
+					if (!r[k]) {
+						r[k] = 1;
+						break;
+					}
+
+					r[k] = 0;
+				}
+			} else {
+				break;
+			}
+		}
+	}
+}
+
+/* Odd multiples P, 3P, 5P, 7P */
+static void wnaf_table(struct ed25519_pt *t, const struct ed25519_pt *p)
+{
+	struct ed25519_pt p2;
+	int i;
+
+	ed25519_double(&p2, p);
+	ed25519_copy(&t[0], p);
+
+	for (i = 1; i < 4; i++)
+		ed25519_add(&t[i], &t[i - 1], &p2);
+}
+
+/* r += digit * t[], for an odd digit in [-7, 7] */
+static void wnaf_add(struct ed25519_pt *r, const struct ed25519_pt *t,
+		     int8_t digit)
+{
+	struct ed25519_pt n;
+
+	if (digit > 0) {
+		ed25519_add(r, r, &t[digit >> 1]);
+	} else {
+		ed25519_copy(&n, &t[(-digit) >> 1]);
+		f25519_neg(n.x, n.x);
+		f25519_neg(n.t, n.t);
+		ed25519_add(r, r, &n);
+	}
+}
+
+void ed25519_smult_add_vartime(struct ed25519_pt *r, const uint8_t *a,
+			       const struct ed25519_pt *p, const uint8_t *b)
+{
+	struct ed25519_pt tb[4];
+	struct ed25519_pt tp[4];
+	int8_t na[256];
+	int8_t nb[256];
+	int i;
+
+	/* Shamir's trick: one shared chain of doublings for both
+	 * exponents, interleaving the additions of each.
+	 */
+	wnaf_recode(na, a);
+	wnaf_recode(nb, b);
+	wnaf_table(tb, &ed25519_base);
+	wnaf_table(tp, p);
+
+	for (i = 255; i >= 0 && !na[i] && !nb[i]; i--)
+		;
+
+	ed25519_copy(r, &ed25519_neutral);
+
+	for (; i >= 0; i--) {
+		ed25519_double(r, r);
+
+		if (na[i])
+			wnaf_add(r, tb, na[i]);
+		if (nb[i])
+			wnaf_add(r, tp, nb[i]);
+	}
+}
+
+#if ED25519_BASE_COMB_ROWS != 0
+/* Affine point prepared for mixed addition: (y+x, y-x, 2dxy) */
+struct ed25519_niels {
+	uint8_t  ypx[F25519_SIZE];
+	uint8_t  ymx[F25519_SIZE];
+	uint8_t  xy2d[F25519_SIZE];
+};
+
+#define ED25519_BASE_COMB_KEEP(row) \
+	(((row) % (32 / ED25519_BASE_COMB_ROWS)) == 0)
+
+/* Row k of the table holds multiples of 16^(SPACING*k) B */
+#define ED25519_BASE_COMB_SPACING  (64 / ED25519_BASE_COMB_ROWS)
+
+#include "ed25519_base_table.h"
+
+static void ed25519_madd(struct ed25519_pt *r,
+			 const struct ed25519_pt *p1,
+			 const struct ed25519_niels *p2)
+{
+	/* As ed25519_add(), with Z2 = 1 and the (Y2-X2), (Y2+X2) and
+	 * k T2 factors taken from the table. Seven multiplications
+	 * instead of nine.
+	 */
+	uint8_t a[F25519_SIZE];
+	uint8_t b[F25519_SIZE];
+	uint8_t c[F25519_SIZE];
+	uint8_t d[F25519_SIZE];
+	uint8_t e[F25519_SIZE];
+	uint8_t f[F25519_SIZE];
+	uint8_t g[F25519_SIZE];
+	uint8_t h[F25519_SIZE];
+
+	/* A = (Y1-X1)(Y2-X2) */
+	f25519_sub(c, p1->y, p1->x);
+	f25519_mul__distinct(a, c, p2->ymx);
+
+	/* B = (Y1+X1)(Y2+X2) */
+	f25519_add(c, p1->y, p1->x);
+	f25519_mul__distinct(b, c, p2->ypx);
+
+	/* C = T1 k T2 */
+	f25519_mul__distinct(c, p1->t, p2->xy2d);
+
+	/* D = 2 Z1 */
+	f25519_add(d, p1->z, p1->z);
+
+	/* E = B - A, F = D - C, G = D + C, H = B + A */
+	f25519_sub(e, b, a);
+	f25519_sub(f, d, c);
+	f25519_add(g, d, c);
+	f25519_add(h, b, a);
+
+	/* X3 = E F, Y3 = G H, T3 = E H, Z3 = F G */
+	f25519_mul__distinct(r->x, e, f);
+	f25519_mul__distinct(r->y, g, h);
+	f25519_mul__distinct(r->t, e, h);
+	f25519_mul__distinct(r->z, f, g);
+}
+
+/* Set r = digit * row[0], for -8 <= digit <= 8. Every entry of the row
+ * is read, so the memory access pattern doesn't depend on the digit.
+ */
+static void comb_select(struct ed25519_niels *r,
+			const struct ed25519_niels *row, int8_t digit)
+{
+	const uint8_t neg = ((uint8_t)digit) >> 7;
+	const uint8_t abs = (((uint8_t)digit) ^ (uint8_t)-neg) + neg;
+	uint8_t tmp[F25519_SIZE];
+	int j;
+
+	/* Neutral element */
+	f25519_load(r->ypx, 1);
+	f25519_load(r->ymx, 1);
+	f25519_load(r->xy2d, 0);
+
+	for (j = 0; j < 8; j++) {
+		const uint8_t hit =
+			(((uint32_t)(abs ^ (j + 1))) - 1) >> 31;
+
+		f25519_select(r->ypx, r->ypx, row[j].ypx, hit);
+		f25519_select(r->ymx, r->ymx, row[j].ymx, hit);
+		f25519_select(r->xy2d, r->xy2d, row[j].xy2d, hit);
+	}
+
+	/* -(x, y) = (-x, y): swap y+x with y-x and negate 2dxy */
+	f25519_copy(tmp, r->ypx);
+	f25519_select(r->ypx, r->ypx, r->ymx, neg);
+	f25519_select(r->ymx, r->ymx, tmp, neg);
+	f25519_neg(tmp, r->xy2d);
+	f25519_select(r->xy2d, r->xy2d, tmp, neg);
+}
+
+/* Recode e into signed radix-16 digits, -8 <= digits[i] < 8, except
+ * for the top one, which is at most 8 since e < 2^255.
+ */
+static void radix16_recode(int8_t *digits, const uint8_t *e)
+{
+	int8_t carry = 0;
+	int i;
+
+	for (i = 0; i < 32; i++) {
+		digits[i * 2] = e[i] & 15;
+		digits[i * 2 + 1] = e[i] >> 4;
+	}
+
+	for (i = 0; i < 63; i++) {
+		digits[i] += carry;
+		carry = (digits[i] + 8) >> 4;
+		digits[i] -= carry * 16;
+	}
+
+	digits[63] += carry;
+}
+
+void ed25519_smult_base(struct ed25519_pt *r, const uint8_t *e)
+{
+	struct ed25519_niels n;
+	int8_t digits[64];
+	int i;
+	int k;
+
+	radix16_recode(digits, e);
+
+	/* eB = sum over columns c of 16^c sum over rows k of
+	 *      digits[SPACING k + c] (16^(SPACING k) B)
+	 */
+	ed25519_copy(r, &ed25519_neutral);
+
+	for (i = ED25519_BASE_COMB_SPACING - 1; i >= 0; i--) {
+		if (i != ED25519_BASE_COMB_SPACING - 1) {
+			ed25519_double(r, r);
+			ed25519_double(r, r);
+			ed25519_double(r, r);
+			ed25519_double(r, r);
+		}
+
+		for (k = 0; k < ED25519_BASE_COMB_ROWS; k++) {
+			comb_select(&n, ed25519_base_comb[k],
+				    digits[ED25519_BASE_COMB_SPACING * k + i]);
+			ed25519_madd(r, r, &n);
+		}
+	}
+}
+
+#if ED25519_X4
+/* Four points in extended coordinates, one per lane */
+struct ed25519x4_pt {
+	struct f25519x4  x;
+	struct f25519x4  y;
+	struct f25519x4  t;
+	struct f25519x4  z;
+};
+
+/* Four points prepared for addition: (Y+X, Y-X, 2dT, 2Z) */
+struct ed25519x4_cached {
+	struct f25519x4  ypx;
+	struct f25519x4  ymx;
+	struct f25519x4  t2d;
+	struct f25519x4  z2;
+};
+
+/* Four comb table entries, as struct ed25519_niels */
+struct ed25519x4_niels {
+	struct f25519x4  ypx;
+	struct f25519x4  ymx;
+	struct f25519x4  xy2d;
+};
+
+static F25519X4_TARGET void x4_gather(struct ed25519x4_pt *r,
+				      const struct ed25519_pt *p)
+{
+	f25519x4_gather(&r->x, p[0].x, p[1].x, p[2].x, p[3].x);
+	f25519x4_gather(&r->y, p[0].y, p[1].y, p[2].y, p[3].y);
+	f25519x4_gather(&r->t, p[0].t, p[1].t, p[2].t, p[3].t);
+	f25519x4_gather(&r->z, p[0].z, p[1].z, p[2].z, p[3].z);
+}
+
+static F25519X4_TARGET void x4_scatter(struct ed25519_pt *r,
+				       const struct ed25519x4_pt *p)
+{
+	f25519x4_scatter(r[0].x, r[1].x, r[2].x, r[3].x, &p->x);
+	f25519x4_scatter(r[0].y, r[1].y, r[2].y, r[3].y, &p->y);
+	f25519x4_scatter(r[0].t, r[1].t, r[2].t, r[3].t, &p->t);
+	f25519x4_scatter(r[0].z, r[1].z, r[2].z, r[3].z, &p->z);
+}
+
+static F25519X4_TARGET void x4_neutral(struct ed25519x4_pt *r)
+{
+	f25519x4_load(&r->x, 0);
+	f25519x4_load(&r->y, 1);
+	f25519x4_load(&r->t, 0);
+	f25519x4_load(&r->z, 1);
+}
+
+/* As ed25519_double(). T3 is only computed if with_t is set: a point
+ * that is doubled again doesn't need it.
+ */
+static F25519X4_TARGET void x4_double(struct ed25519x4_pt *r,
+				      const struct ed25519x4_pt *p,
+				      int with_t)
+{
+	struct f25519x4 a;
+	struct f25519x4 b;
+	struct f25519x4 c;
+	struct f25519x4 e;
+	struct f25519x4 f;
+	struct f25519x4 g;
+	struct f25519x4 h;
+
+	/* A = X1^2, B = Y1^2, C = 2 Z1^2 */
+	f25519x4_sqr(&a, &p->x);
+	f25519x4_sqr(&b, &p->y);
+	f25519x4_sqr(&c, &p->z);
+	f25519x4_add(&c, &c, &c);
+
+	/* E = (X1+Y1)^2-A-B */
+	f25519x4_add(&f, &p->x, &p->y);
+	f25519x4_sqr(&e, &f);
+	f25519x4_sub(&e, &e, &a);
+	f25519x4_sub(&e, &e, &b);
+
+	/* G = B - A, F = G - C, H = -B - A */
+	f25519x4_sub(&g, &b, &a);
+	f25519x4_sub(&f, &g, &c);
+	f25519x4_add(&h, &a, &b);
+	f25519x4_neg(&h, &h);
+
+	/* X3 = E F, Y3 = G H, T3 = E H, Z3 = F G */
+	f25519x4_mul(&r->x, &e, &f);
+	f25519x4_mul(&r->y, &g, &h);
+	if (with_t)
+		f25519x4_mul(&r->t, &e, &h);
+	f25519x4_mul(&r->z, &f, &g);
+}
+
+/* Second half of ed25519_add(), from A, B, C and D */
+static F25519X4_TARGET void x4_add_finish(struct ed25519x4_pt *r,
+					  const struct f25519x4 *a,
+					  const struct f25519x4 *b,
+					  const struct f25519x4 *c,
+					  const struct f25519x4 *d)
+{
+	struct f25519x4 e;
+	struct f25519x4 f;
+	struct f25519x4 g;
+	struct f25519x4 h;
+
+	/* E = B - A, F = D - C, G = D + C, H = B + A */
+	f25519x4_sub(&e, b, a);
+	f25519x4_sub(&f, d, c);
+	f25519x4_add(&g, d, c);
+	f25519x4_add(&h, b, a);
+
+	/* X3 = E F, Y3 = G H, T3 = E H, Z3 = F G */
+	f25519x4_mul(&r->x, &e, &f);
+	f25519x4_mul(&r->y, &g, &h);
+	f25519x4_mul(&r->t, &e, &h);
+	f25519x4_mul(&r->z, &f, &g);
+}
+
+/* As ed25519_add(), with the second point prepared by x4_cache() */
+static F25519X4_TARGET void x4_add(struct ed25519x4_pt *r,
+				   const struct ed25519x4_pt *p1,
+				   const struct ed25519x4_cached *p2)
+{
+	struct f25519x4 a;
+	struct f25519x4 b;
+	struct f25519x4 c;
+	struct f25519x4 d;
+
+	f25519x4_sub(&c, &p1->y, &p1->x);
+	f25519x4_mul(&a, &c, &p2->ymx);
+	f25519x4_add(&c, &p1->y, &p1->x);
+	f25519x4_mul(&b, &c, &p2->ypx);
+	f25519x4_mul(&c, &p1->t, &p2->t2d);
+	f25519x4_mul(&d, &p1->z, &p2->z2);
+
+	x4_add_finish(r, &a, &b, &c, &d);
+}
+
+/* As ed25519_madd() */
+static F25519X4_TARGET void x4_madd(struct ed25519x4_pt *r,
+				    const struct ed25519x4_pt *p1,
+				    const struct ed25519x4_niels *p2)
+{
+	struct f25519x4 a;
+	struct f25519x4 b;
+	struct f25519x4 c;
+	struct f25519x4 d;
+
+	f25519x4_sub(&c, &p1->y, &p1->x);
+	f25519x4_mul(&a, &c, &p2->ymx);
+	f25519x4_add(&c, &p1->y, &p1->x);
+	f25519x4_mul(&b, &c, &p2->ypx);
+	f25519x4_mul(&c, &p1->t, &p2->xy2d);
+	f25519x4_add(&d, &p1->z, &p1->z);
+
+	x4_add_finish(r, &a, &b, &c, &d);
+}
+
+static F25519X4_TARGET void x4_cache(struct ed25519x4_cached *r,
+				     const struct ed25519x4_pt *p)
+{
+	struct f25519x4 k;
+
+	f25519x4_gather(&k, ed25519_k, ed25519_k, ed25519_k, ed25519_k);
+	f25519x4_add(&r->ypx, &p->y, &p->x);
+	f25519x4_sub(&r->ymx, &p->y, &p->x);
+	f25519x4_mul(&r->t2d, &p->t, &k);
+	f25519x4_add(&r->z2, &p->z, &p->z);
+}
+
+/* Set r = digit[i] * t[0] in lane i, for -8 <= digit[i] <= 8, with
+ * t[j] = (j + 1) t[0]. Every entry is read and blended in, so the
+ * memory access pattern doesn't depend on the digits.
+ */
+static F25519X4_TARGET void x4_select(struct ed25519x4_cached *r,
+				      const struct ed25519x4_cached *t,
+				      const int8_t *digit)
+{
+	const __m256i d = _mm256_set_epi64x(digit[3], digit[2],
+					    digit[1], digit[0]);
+	const __m256i neg = _mm256_cmpgt_epi64(_mm256_setzero_si256(), d);
+	const __m256i abs = _mm256_sub_epi64(_mm256_xor_si256(d, neg), neg);
+	struct f25519x4 tmp;
+	int j;
+
+	/* Neutral element */
+	f25519x4_load(&r->ypx, 1);
+	f25519x4_load(&r->ymx, 1);
+	f25519x4_load(&r->t2d, 0);
+	f25519x4_load(&r->z2, 2);
+
+	for (j = 0; j < 8; j++) {
+		const __m256i hit =
+			_mm256_cmpeq_epi64(abs, _mm256_set1_epi64x(j + 1));
+
+		f25519x4_select(&r->ypx, &r->ypx, &t[j].ypx, &hit);
+		f25519x4_select(&r->ymx, &r->ymx, &t[j].ymx, &hit);
+		f25519x4_select(&r->t2d, &r->t2d, &t[j].t2d, &hit);
+		f25519x4_select(&r->z2, &r->z2, &t[j].z2, &hit);
+	}
+
+	/* -(X, Y, Z, T) = (-X, Y, Z, -T) */
+	tmp = r->ypx;
+	f25519x4_select(&r->ypx, &r->ypx, &r->ymx, &neg);
+	f25519x4_select(&r->ymx, &r->ymx, &tmp, &neg);
+	f25519x4_neg(&tmp, &r->t2d);
+	f25519x4_select(&r->t2d, &r->t2d, &tmp, &neg);
+}
+
+/* The comb table in split form: y+x, y-x and 2dxy of each entry */
+typedef f25519x4_limbs ed25519x4_comb_row[8][3];
+
+/* As comb_select(), with a digit per lane */
+static F25519X4_TARGET void x4_comb_select(struct ed25519x4_niels *r,
+					   ed25519x4_comb_row row,
+					   const int8_t *digit)
+{
+	const __m256i d = _mm256_set_epi64x(digit[3], digit[2],
+					    digit[1], digit[0]);
+	const __m256i neg = _mm256_cmpgt_epi64(_mm256_setzero_si256(), d);
+	const __m256i abs = _mm256_sub_epi64(_mm256_xor_si256(d, neg), neg);
+	struct f25519x4 tmp;
+	int j;
+
+	/* Neutral element */
+	f25519x4_load(&r->ypx, 1);
+	f25519x4_load(&r->ymx, 1);
+	f25519x4_load(&r->xy2d, 0);
+
+	for (j = 0; j < 8; j++) {
+		const __m256i hit =
+			_mm256_cmpeq_epi64(abs, _mm256_set1_epi64x(j + 1));
+
+		f25519x4_select_limbs(&r->ypx, &r->ypx, row[j][0], &hit);
+		f25519x4_select_limbs(&r->ymx, &r->ymx, row[j][1], &hit);
+		f25519x4_select_limbs(&r->xy2d, &r->xy2d, row[j][2], &hit);
+	}
+
+	/* -(x, y) = (-x, y): swap y+x with y-x and negate 2dxy */
+	tmp = r->ypx;
+	f25519x4_select(&r->ypx, &r->ypx, &r->ymx, &neg);
+	f25519x4_select(&r->ymx, &r->ymx, &tmp, &neg);
+	f25519x4_neg(&tmp, &r->xy2d);
+	f25519x4_select(&r->xy2d, &r->xy2d, &tmp, &neg);
+}
+
+/* As ed25519_smult_base(), in each lane */
+static F25519X4_TARGET void x4_smult_base(struct ed25519x4_pt *r,
+					  const uint8_t *const *e)
+{
+	ed25519x4_comb_row table[ED25519_BASE_COMB_ROWS];
+	struct ed25519x4_niels n;
+	int8_t digits[4][64];
+	int8_t column[4];
+	int i;
+	int j;
+	int k;
+
+	/* Split the table once, rather than gathering from bytes on
+	 * every addition
+	 */
+	for (k = 0; k < ED25519_BASE_COMB_ROWS; k++) {
+		for (j = 0; j < 8; j++) {
+			f25519x4_split(table[k][j][0],
+				       ed25519_base_comb[k][j].ypx);
+			f25519x4_split(table[k][j][1],
+				       ed25519_base_comb[k][j].ymx);
+			f25519x4_split(table[k][j][2],
+				       ed25519_base_comb[k][j].xy2d);
+		}
+	}
+
+	for (j = 0; j < 4; j++)
+		radix16_recode(digits[j], e[j]);
+
+	x4_neutral(r);
+
+	for (i = ED25519_BASE_COMB_SPACING - 1; i >= 0; i--) {
+		if (i != ED25519_BASE_COMB_SPACING - 1) {
+			x4_double(r, r, 0);
+			x4_double(r, r, 0);
+			x4_double(r, r, 0);
+			x4_double(r, r, 1);
+		}
+
+		for (k = 0; k < ED25519_BASE_COMB_ROWS; k++) {
+			for (j = 0; j < 4; j++)
+				column[j] = digits[j][ED25519_BASE_COMB_SPACING * k + i];
+
+			x4_comb_select(&n, table[k], column);
+			x4_madd(r, r, &n);
+		}
+	}
+}
+
+F25519X4_TARGET void ed25519x4_smult_base(struct ed25519_pt *r,
+					  const uint8_t *const *e)
+{
+	struct ed25519x4_pt p;
+
+	x4_smult_base(&p, e);
+	x4_scatter(r, &p);
+}
+
+F25519X4_TARGET void ed25519x4_smult_add_vartime(struct ed25519_pt *r,
+						 const uint8_t *const *a,
+						 const struct ed25519_pt *p,
+						 const uint8_t *const *b)
+{
+	struct ed25519x4_cached t[8];
+	struct ed25519x4_cached c;
+	struct ed25519x4_pt q;
+	struct ed25519x4_pt s;
+	int8_t digits[4][64];
+	int8_t column[4];
+	int i;
+	int j;
+
+	/* Multiples P, 2P, ..., 8P of each lane's point */
+	x4_gather(&q, p);
+	x4_cache(&t[0], &q);
+	x4_double(&s, &q, 1);
+	x4_cache(&t[1], &s);
+
+	for (i = 2; i < 8; i++) {
+		x4_add(&s, &s, &t[0]);
+		x4_cache(&t[i], &s);
+	}
+
+	/* bP with a fixed signed radix-16 window. Lanes can't skip
+	 * additions independently, so a wNAF would gain nothing here.
+	 */
+	for (j = 0; j < 4; j++)
+		radix16_recode(digits[j], b[j]);
+
+	x4_neutral(&q);
+
+	for (i = 63; i >= 0; i--) {
+		if (i != 63) {
+			x4_double(&q, &q, 0);
+			x4_double(&q, &q, 0);
+			x4_double(&q, &q, 0);
+			x4_double(&q, &q, 1);
+		}
+
+		for (j = 0; j < 4; j++)
+			column[j] = digits[j][i];
+
+		x4_select(&c, t, column);
+		x4_add(&q, &q, &c);
+	}
+
+	/* Add aB from the comb */
+	x4_smult_base(&s, a);
+	x4_cache(&c, &s);
+	x4_add(&q, &q, &c);
+
+	x4_scatter(r, &q);
+}
+#endif
+#else
+void ed25519_smult_base(struct ed25519_pt *r, const uint8_t *e)
+{
+	ed25519_smult(r, &ed25519_base, e);
+}
+#endif
 #endif
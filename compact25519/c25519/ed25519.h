@@ -9,6 +9,7 @@
 
 #ifndef COMPACT_DISABLE_ED25519
 #include "f25519.h"
+#include "f25519x4.h"
 
 /* This is not the Ed25519 signature system. Rather, we're implementing
  * basic operations on the twisted Edwards curve over (Z mod 2^255-19):
@@ -80,5 +81,72 @@ void ed25519_double(struct ed25519_pt *r, const struct ed25519_pt *a);
 void ed25519_smult(struct ed25519_pt *r, const struct ed25519_pt *a,
 		   const uint8_t *e);
 
+/* Fixed-base multiplication r = eB by the base point. The exponent must
+ * be below 2^255 (e[31] < 128); clamped exponents and values reduced
+ * mod the group order both qualify.
+ *
+ * With ED25519_BASE_COMB_ROWS set, this uses a signed radix-16 comb
+ * over a precomputed table of ROWS x 8 affine points (96 bytes each)
+ * kept in flash, in place of the generic ladder:
+ *
+ *     ROWS   table     doublings  additions
+ *       0    none         256        256    (ladder, as ed25519_smult)
+ *       1    768 B        252         64
+ *       2    1.5 KB       124         64
+ *       4    3 KB          60         64
+ *       8    6 KB          28         64
+ *      16    12 KB         12         64
+ *      32    24 KB          4         64
+ *
+ * AVR builds default to 0, because const data is copied to RAM there.
+ */
+#ifndef ED25519_BASE_COMB_ROWS
+#if defined(__AVR__)
+#define ED25519_BASE_COMB_ROWS  0
+#else
+#define ED25519_BASE_COMB_ROWS  8
+#endif
+#endif
+
+#if ED25519_BASE_COMB_ROWS != 0 && ED25519_BASE_COMB_ROWS != 1 && \
+    ED25519_BASE_COMB_ROWS != 2 && ED25519_BASE_COMB_ROWS != 4 && \
+    ED25519_BASE_COMB_ROWS != 8 && ED25519_BASE_COMB_ROWS != 16 && \
+    ED25519_BASE_COMB_ROWS != 32
+#error "ED25519_BASE_COMB_ROWS must be 0, 1, 2, 4, 8, 16 or 32"
+#endif
+
+void ed25519_smult_base(struct ed25519_pt *r, const uint8_t *e);
+
+/* Double-scalar multiplication r = aB + bP, for verification. This is
+ * NOT constant time: use it only when a, b and P are public. Both
+ * exponents must be below 2^255.
+ */
+void ed25519_smult_add_vartime(struct ed25519_pt *r, const uint8_t *a,
+			       const struct ed25519_pt *p, const uint8_t *b);
+
+/* Four-way versions of ed25519_smult_base() and
+ * ed25519_smult_add_vartime() for batches, with f25519x4 arithmetic:
+ *
+ *     r[i] = e[i] B               (constant time)
+ *     r[i] = a[i] B + b[i] p[i]   (NOT constant time)
+ *
+ * for i = 0..3, with the same bounds on exponents as the one-way
+ * functions. They need the comb table, and may only be called when
+ * f25519x4_available() returns non-zero.
+ */
+#if F25519_X4 && ED25519_BASE_COMB_ROWS != 0
+#define ED25519_X4  1
+#else
+#define ED25519_X4  0
+#endif
+
+#if ED25519_X4
+void ed25519x4_smult_base(struct ed25519_pt *r, const uint8_t *const *e);
+void ed25519x4_smult_add_vartime(struct ed25519_pt *r,
+				 const uint8_t *const *a,
+				 const struct ed25519_pt *p,
+				 const uint8_t *const *b);
+#endif
+
 #endif
 #endif
@@ -8,25 +8,23 @@
 
 #ifndef COMPACT_DISABLE_ED25519
 #include "sha512.h"
-#include "fprime.h"
+#include "sc25519.h"
 #include "edsign.h"
 
-#define EXPANDED_SIZE  64
-
-static const uint8_t ed25519_order[FPRIME_SIZE] = {
+static const uint8_t ed25519_order[SC25519_SIZE] = {
 	0xed, 0xd3, 0xf5, 0x5c, 0x1a, 0x63, 0x12, 0x58,
 	0xd6, 0x9c, 0xf7, 0xa2, 0xde, 0xf9, 0xde, 0x14,
 	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
 	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x10
 };
 
-static void expand_key(uint8_t *expanded, const uint8_t *secret)
+void edsign_expand_key(uint8_t *expanded, const uint8_t *secret)
 {
 	struct sha512_state s;
 
 	sha512_init(&s);
 	sha512_final(&s, secret, EDSIGN_SECRET_KEY_SIZE);
-	sha512_get(&s, expanded, 0, EXPANDED_SIZE);
+	sha512_get(&s, expanded, 0, EDSIGN_EXPANDED_SIZE);
 	ed25519_prepare(expanded);
 }
 
@@ -49,19 +47,25 @@ static void pp(uint8_t *packed, const struct ed25519_pt *p)
 	ed25519_pack(packed, x, y);
 }
 
+/* k must be below 2^255, see ed25519_smult_base() */
 static void sm_pack(uint8_t *r, const uint8_t *k)
 {
 	struct ed25519_pt p;
 
-	ed25519_smult(&p, &ed25519_base, k);
+	ed25519_smult_base(&p, k);
 	pp(r, &p);
 }
 
 void edsign_sec_to_pub(uint8_t *pub, const uint8_t *secret)
 {
-	uint8_t expanded[EXPANDED_SIZE];
+	uint8_t expanded[EDSIGN_EXPANDED_SIZE];
 
-	expand_key(expanded, secret);
+	edsign_expand_key(expanded, secret);
+	sm_pack(pub, expanded);
+}
+
+void edsign_expanded_to_pub(uint8_t *pub, const uint8_t *expanded)
+{
 	sm_pack(pub, expanded);
 }
 
@@ -92,7 +96,7 @@ static void hash_with_prefix(uint8_t *out_fp,
 	}
 
 	sha512_get(&s, init_block, 0, SHA512_HASH_SIZE);
-	fprime_from_bytes(out_fp, init_block, SHA512_HASH_SIZE, ed25519_order);
+	sc25519_reduce(out_fp, init_block);
 }
 
 static void generate_k(uint8_t *k, const uint8_t *kgen_key,
@@ -114,17 +118,70 @@ static void hash_message(uint8_t *z, const uint8_t *r, const uint8_t *a,
 	hash_with_prefix(z, block, 64, m, len);
 }
 
+/* out[i] = H(head[i] || message[i]) mod L for i < count, heads being
+ * head_size bytes, as hash_with_prefix() computes it. Four at a time if
+ * the CPU can, padding the last group by repeating its last message.
+ */
+static void hash_with_prefix_batch(uint8_t (*out)[SC25519_SIZE],
+				   const uint8_t *const *heads,
+				   unsigned int head_size,
+				   const uint8_t *const *messages,
+				   const size_t *lens, unsigned int count)
+{
+	uint8_t block[SHA512_BLOCK_SIZE];
+	unsigned int i = 0;
+
+#if SHA512_X4
+	if (sha512x4_available()) {
+		while (i < count) {
+			uint8_t hash[4][SHA512_HASH_SIZE];
+			uint8_t *h[4];
+			const uint8_t *hd[4];
+			const uint8_t *m[4];
+			size_t l[4];
+			unsigned int j;
+
+			for (j = 0; j < 4; j++) {
+				const unsigned int k =
+					(i + j < count) ? i + j : count - 1;
+
+				h[j] = hash[j];
+				hd[j] = heads[k];
+				m[j] = messages[k];
+				l[j] = lens[k];
+			}
+
+			sha512x4(h, hd, head_size, m, l);
+
+			for (j = 0; j < 4 && i < count; j++, i++)
+				sc25519_reduce(out[i], hash[j]);
+		}
+	}
+#endif
+
+	for (; i < count; i++) {
+		memcpy(block, heads[i], head_size);
+		hash_with_prefix(out[i], block, head_size,
+				 messages[i], lens[i]);
+	}
+}
+
 void edsign_sign(uint8_t *signature, const uint8_t *pub,
 		 const uint8_t *secret,
 		 const uint8_t *message, size_t len)
 {
-	uint8_t expanded[EXPANDED_SIZE];
-	uint8_t e[FPRIME_SIZE];
-	uint8_t s[FPRIME_SIZE];
-	uint8_t k[FPRIME_SIZE];
-	uint8_t z[FPRIME_SIZE];
+	uint8_t expanded[EDSIGN_EXPANDED_SIZE];
 
-	expand_key(expanded, secret);
+	edsign_expand_key(expanded, secret);
+	edsign_sign_expanded(signature, pub, expanded, message, len);
+}
+
+void edsign_sign_expanded(uint8_t *signature, const uint8_t *pub,
+			  const uint8_t *expanded,
+			  const uint8_t *message, size_t len)
+{
+	uint8_t k[SC25519_SIZE];
+	uint8_t z[SC25519_SIZE];
 
 	/* Generate k and R = kB */
 	generate_k(k, expanded + 32, message, len);
@@ -133,13 +190,179 @@ void edsign_sign(uint8_t *signature, const uint8_t *pub,
 	/* Compute z = H(R, A, M) */
 	hash_message(z, signature, pub, message, len);
 
-	/* Obtain e */
-	fprime_from_bytes(e, expanded, 32, ed25519_order);
+	/* Compute s = ze + k, with e the clamped secret scalar */
+	sc25519_mul_add(signature + 32, z, expanded, k);
+}
 
-	/* Compute s = ze + k */
-	fprime_mul(s, z, e, ed25519_order);
-	fprime_add(s, k, ed25519_order);
-	memcpy(signature + 32, s, 32);
+/* p[i] = k[i] B for i < count, four at a time if the CPU can. A short
+ * last group is padded out by repeating its last exponent: even one
+ * used lane is faster than a one-way multiplication.
+ */
+static void smult_base_batch(struct ed25519_pt *p,
+			     uint8_t (*k)[SC25519_SIZE], unsigned int count)
+{
+	unsigned int i = 0;
+
+#if ED25519_X4
+	if (f25519x4_available()) {
+		while (i < count) {
+			struct ed25519_pt r[4];
+			const uint8_t *e[4];
+			unsigned int j;
+
+			for (j = 0; j < 4; j++)
+				e[j] = k[(i + j < count) ? i + j : count - 1];
+
+			ed25519x4_smult_base(r, e);
+
+			for (j = 0; j < 4 && i < count; j++, i++)
+				ed25519_copy(&p[i], &r[j]);
+		}
+	}
+#endif
+
+	for (; i < count; i++)
+		ed25519_smult_base(&p[i], k[i]);
+}
+
+void edsign_sign_expanded_batch(uint8_t *signatures, const uint8_t *pub,
+				const uint8_t *expanded,
+				const uint8_t *const *messages,
+				const size_t *lens, unsigned int count)
+{
+	struct ed25519_pt p[EDSIGN_BATCH_MAX];
+	uint8_t k[EDSIGN_BATCH_MAX][SC25519_SIZE];
+	uint8_t acc[EDSIGN_BATCH_MAX][F25519_SIZE];
+	uint8_t z[EDSIGN_BATCH_MAX][SC25519_SIZE];
+	uint8_t ra[EDSIGN_BATCH_MAX][64];
+	const uint8_t *heads[EDSIGN_BATCH_MAX];
+	uint8_t inv[F25519_SIZE];
+	uint8_t z1[F25519_SIZE];
+	uint8_t x[F25519_SIZE];
+	uint8_t y[F25519_SIZE];
+	unsigned int i;
+
+	if (!count)
+		return;
+
+	/* Generate each k and R = kB, leaving R in projective form */
+	for (i = 0; i < count; i++)
+		heads[i] = expanded + 32;
+
+	hash_with_prefix_batch(k, heads, 32, messages, lens, count);
+
+	smult_base_batch(p, k, count);
+
+	/* Montgomery's trick: acc[i] = Z_0 ... Z_i, invert the full
+	 * product once, then peel off 1/Z_i from the last point down.
+	 */
+	f25519_copy(acc[0], p[0].z);
+	for (i = 1; i < count; i++)
+		f25519_mul__distinct(acc[i], acc[i - 1], p[i].z);
+
+	f25519_inv__distinct(inv, acc[count - 1]);
+
+	for (i = count; i-- > 0; ) {
+		if (i) {
+			f25519_mul__distinct(z1, inv, acc[i - 1]);
+			f25519_mul__distinct(x, inv, p[i].z);
+			f25519_copy(inv, x);
+		} else {
+			f25519_copy(z1, inv);
+		}
+
+		f25519_mul__distinct(x, p[i].x, z1);
+		f25519_mul__distinct(y, p[i].y, z1);
+		ed25519_pack(signatures + i * EDSIGN_SIGNATURE_SIZE, x, y);
+	}
+
+	/* Compute z = H(R, A, M) and s = ze + k for each message */
+	for (i = 0; i < count; i++) {
+		memcpy(ra[i], signatures + i * EDSIGN_SIGNATURE_SIZE, 32);
+		memcpy(ra[i] + 32, pub, 32);
+		heads[i] = ra[i];
+	}
+
+	hash_with_prefix_batch(z, heads, 64, messages, lens, count);
+
+	for (i = 0; i < count; i++)
+		sc25519_mul_add(signatures + i * EDSIGN_SIGNATURE_SIZE + 32,
+				z[i], expanded, k[i]);
+}
+
+/* Is s a canonical scalar, 0 <= s < L? Not constant time. */
+static uint8_t scalar_is_canonical(const uint8_t *s)
+{
+	int i;
+
+	for (i = SC25519_SIZE - 1; i >= 0; i--) {
+		if (s[i] < ed25519_order[i])
+			return 1;
+		if (s[i] > ed25519_order[i])
+			return 0;
+	}
+
+	return 0;
+}
+
+/* Is p the neutral element (0, 1)? Not constant time. */
+static uint8_t is_neutral(const struct ed25519_pt *p)
+{
+	uint8_t zero[F25519_SIZE];
+	uint8_t x[F25519_SIZE];
+	uint8_t y[F25519_SIZE];
+	uint8_t z[F25519_SIZE];
+
+	f25519_load(zero, 0);
+	f25519_copy(x, p->x);
+	f25519_copy(y, p->y);
+	f25519_copy(z, p->z);
+	f25519_normalize(x);
+	f25519_normalize(y);
+	f25519_normalize(z);
+
+	return f25519_eq(x, zero) & f25519_eq(y, z);
+}
+
+/* First half of a verification: check s, unpack -A and -R. Returns
+ * zero if the signature can already be rejected. The caller computes
+ * z = H(R, A, M).
+ */
+static uint8_t verify_prepare(struct ed25519_pt *na, struct ed25519_pt *nr,
+			      const uint8_t *signature, const uint8_t *pub)
+{
+	/* Everything here is public, so the checks may exit early and
+	 * the arithmetic needn't be constant time.
+	 *
+	 * Reject s >= L, so that signatures aren't malleable.
+	 */
+	if (!scalar_is_canonical(signature + 32))
+		return 0;
+
+	/* Unpack -A and -R */
+	if (!upp(na, pub) || !upp(nr, signature))
+		return 0;
+
+	f25519_neg(na->x, na->x);
+	f25519_neg(na->t, na->t);
+	f25519_neg(nr->x, nr->x);
+	f25519_neg(nr->t, nr->t);
+	return 1;
+}
+
+/* Second half: given p = sB - zA, check [8](p - R) = 0. This is the
+ * cofactored equation monocypher uses, so both backends accept the
+ * same signatures.
+ */
+static uint8_t verify_finish(struct ed25519_pt *p,
+			     const struct ed25519_pt *nr)
+{
+	ed25519_add(p, p, nr);
+	ed25519_double(p, p);
+	ed25519_double(p, p);
+	ed25519_double(p, p);
+
+	return is_neutral(p);
 }
 
 uint8_t edsign_verify(const uint8_t *signature, const uint8_t *pub,
@@ -147,25 +370,80 @@ uint8_t edsign_verify(const uint8_t *signature, const uint8_t *pub,
 {
 	struct ed25519_pt p;
 	struct ed25519_pt q;
-	uint8_t lhs[F25519_SIZE];
-	uint8_t rhs[F25519_SIZE];
-	uint8_t z[FPRIME_SIZE];
-	uint8_t ok = 1;
+	uint8_t z[SC25519_SIZE];
+
+	if (!verify_prepare(&p, &q, signature, pub))
+		return 0;
 
 	/* Compute z = H(R, A, M) */
 	hash_message(z, signature, pub, message, len);
 
-	/* sB = (ze + k)B = ... */
-	sm_pack(lhs, signature + 32);
+	ed25519_smult_add_vartime(&p, signature + 32, &p, z);
+	return verify_finish(&p, &q);
+}
+
+uint8_t edsign_verify_batch(const uint8_t *const *signatures,
+			    const uint8_t *const *pubs,
+			    const uint8_t *const *messages,
+			    const size_t *lens, unsigned int count)
+{
+	unsigned int i = 0;
+
+#if ED25519_X4
+	/* Four signatures per double-scalar multiplication, padding the
+	 * last group as in smult_base_batch()
+	 */
+	if (f25519x4_available()) {
+		while (i < count) {
+			struct ed25519_pt p[4];
+			struct ed25519_pt q[4];
+			uint8_t z[4][SC25519_SIZE];
+			uint8_t ra[4][64];
+			const uint8_t *heads[4];
+			const uint8_t *s[4];
+			const uint8_t *zs[4];
+			const unsigned int n = (count - i < 4) ? count - i : 4;
+			unsigned int j;
+
+			for (j = 0; j < n; j++) {
+				if (!verify_prepare(&p[j], &q[j],
+						    signatures[i + j],
+						    pubs[i + j]))
+					return 0;
+
+				memcpy(ra[j], signatures[i + j], 32);
+				memcpy(ra[j] + 32, pubs[i + j], 32);
+				heads[j] = ra[j];
+				s[j] = signatures[i + j] + 32;
+				zs[j] = z[j];
+			}
+
+			/* Compute each z = H(R, A, M) */
+			hash_with_prefix_batch(z, heads, 64, messages + i,
+					       lens + i, n);
+
+			for (; j < 4; j++) {
+				ed25519_copy(&p[j], &p[n - 1]);
+				s[j] = s[n - 1];
+				zs[j] = zs[n - 1];
+			}
+
+			ed25519x4_smult_add_vartime(p, s, p, zs);
+
+			for (j = 0; j < n; j++)
+				if (!verify_finish(&p[j], &q[j]))
+					return 0;
+
+			i += n;
+		}
+	}
+#endif
 
-	/* ... = zA + R */
-	ok &= upp(&p, pub);
-	ed25519_smult(&p, &p, z);
-	ok &= upp(&q, signature);
-	ed25519_add(&p, &p, &q);
-	pp(rhs, &p);
+	for (; i < count; i++)
+		if (!edsign_verify(signatures[i], pubs[i],
+				   messages[i], lens[i]))
+			return 0;
 
-	/* Equal? */
-	return ok & f25519_eq(lhs, rhs);
+	return 1;
 }
 #endif
@@ -45,9 +45,50 @@ void edsign_sign(uint8_t *signature, const uint8_t *pub,
 		 const uint8_t *secret,
 		 const uint8_t *message, size_t len);
 
+/* Expanded secret key: the clamped scalar followed by the 32-byte key
+ * used for nonce generation. A signer that makes many signatures with
+ * the same key can expand it once and skip the key hash on every
+ * signature.
+ */
+#define EDSIGN_EXPANDED_SIZE  64
+
+void edsign_expand_key(uint8_t *expanded, const uint8_t *secret);
+
+/* Given an expanded secret key, produce the public key. */
+void edsign_expanded_to_pub(uint8_t *pub, const uint8_t *expanded);
+
+/* Produce a signature for a message from an expanded secret key. */
+void edsign_sign_expanded(uint8_t *signature, const uint8_t *pub,
+			  const uint8_t *expanded,
+			  const uint8_t *message, size_t len);
+
+/* Sign count messages with the same expanded key, writing count
+ * consecutive signatures. Rather than one field inversion per R point,
+ * all of them are packed with a single shared inversion. count must
+ * not exceed EDSIGN_BATCH_MAX, which bounds stack use (about 200 bytes
+ * per message).
+ */
+#ifndef EDSIGN_BATCH_MAX
+#define EDSIGN_BATCH_MAX  8
+#endif
+
+void edsign_sign_expanded_batch(uint8_t *signatures, const uint8_t *pub,
+				const uint8_t *expanded,
+				const uint8_t *const *messages,
+				const size_t *lens, unsigned int count);
+
 /* Verify a message signature. Returns non-zero if ok. */
 uint8_t edsign_verify(const uint8_t *signature, const uint8_t *pub,
 		      const uint8_t *message, size_t len);
 
+/* Verify count signatures, each with its own public key and message.
+ * Returns non-zero if all of them are ok. On x86 with AVX2, four
+ * signatures share each double-scalar multiplication.
+ */
+uint8_t edsign_verify_batch(const uint8_t *const *signatures,
+			    const uint8_t *const *pubs,
+			    const uint8_t *const *messages,
+			    const size_t *lens, unsigned int count);
+
 #endif
 #endif
@@ -74,6 +74,7 @@ uint8_t f25519_eq(const uint8_t *x, const uint8_t *y)
 	return (sum ^ 1) & 1;
 }
 
+#if F25519_BACKEND != F25519_BACKEND_LIMB64
 void f25519_select(uint8_t *dst,
 		   const uint8_t *zero, const uint8_t *one,
 		   uint8_t condition)
@@ -84,6 +85,7 @@ void f25519_select(uint8_t *dst,
 	for (i = 0; i < F25519_SIZE; i++)
 		dst[i] = zero[i] ^ (mask & (one[i] ^ zero[i]));
 }
+#endif
 
 void f25519_add(uint8_t *r, const uint8_t *a, const uint8_t *b)
 {
@@ -156,6 +158,7 @@ void f25519_neg(uint8_t *r, const uint8_t *a)
 	}
 }
 
+#if F25519_BACKEND == F25519_BACKEND_BYTES
 void f25519_mul__distinct(uint8_t *r, const uint8_t *a, const uint8_t *b)
 {
 	uint32_t c = 0;
@@ -217,54 +220,103 @@ void f25519_mul_c(uint8_t *r, const uint8_t *a, uint32_t b)
 	}
 }
 
-void f25519_inv__distinct(uint8_t *r, const uint8_t *x)
+void f25519_sqr(uint8_t *r, const uint8_t *a)
 {
-	uint8_t s[F25519_SIZE];
+	uint8_t tmp[F25519_SIZE];
+	uint32_t c = 0;
 	int i;
 
-	/* This is a prime field, so by Fermat's little theorem:
-	 *
-	 *     x^(p-1) = 1 mod p
-	 *
-	 * Therefore, raise to (p-2) = 2^255-21 to get a multiplicative
-	 * inverse.
-	 *
-	 * This is a 255-bit binary number with the digits:
-	 *
-	 *     11111111... 01011
-	 *
-	 * We compute the result by the usual binary chain, but
-	 * alternate between keeping the accumulator in r and s, so as
-	 * to avoid copying temporaries.
+	/* As f25519_mul__distinct(), but each cross product a[j]a[k]
+	 * (j != k) is computed once and doubled.
 	 */
+	for (i = 0; i < F25519_SIZE; i++) {
+		int j;
 
-	/* 1 1 */
-	f25519_mul__distinct(s, x, x);
-	f25519_mul__distinct(r, s, x);
+		c >>= 8;
+		for (j = 0; j * 2 < i; j++)
+			c += ((uint32_t)a[j]) * ((uint32_t)a[i - j]) * 2;
+
+		for (j = i + 1; j * 2 < i + F25519_SIZE; j++)
+			c += ((uint32_t)a[j]) *
+			     ((uint32_t)a[i + F25519_SIZE - j]) * 76;
+
+		if (!(i & 1)) {
+			const uint32_t lo = a[i >> 1];
+			const uint32_t hi = a[(i + F25519_SIZE) >> 1];
+
+			c += lo * lo + hi * hi * 38;
+		}
 
-	/* 1 x 248 */
-	for (i = 0; i < 248; i++) {
-		f25519_mul__distinct(s, r, r);
-		f25519_mul__distinct(r, s, x);
+		tmp[i] = c;
 	}
 
-	/* 0 */
-	f25519_mul__distinct(s, r, r);
+	tmp[31] &= 127;
+	c = (c >> 7) * 19;
+
+	for (i = 0; i < F25519_SIZE; i++) {
+		c += tmp[i];
+		r[i] = c;
+		c >>= 8;
+	}
+}
 
-	/* 1 */
-	f25519_mul__distinct(r, s, s);
-	f25519_mul__distinct(s, r, x);
+/* Square n times */
+static void sqr_n(uint8_t *r, const uint8_t *a, int n)
+{
+	f25519_sqr(r, a);
+	while (--n)
+		f25519_sqr(r, r);
+}
 
-	/* 0 */
-	f25519_mul__distinct(r, s, s);
+/* Compute r = x^(2^250-1) and z11 = x^11, the common prefix of the
+ * addition chains for (p-2) and (p-5)/8. r, z11 and x must be distinct.
+ */
+static void pow250(uint8_t *r, uint8_t *z11, const uint8_t *x)
+{
+	uint8_t a[F25519_SIZE];
+	uint8_t b[F25519_SIZE];
+	uint8_t c[F25519_SIZE];
+
+	f25519_sqr(a, x);			/* 2 */
+	sqr_n(b, a, 2);				/* 8 */
+	f25519_mul__distinct(c, b, x);		/* 9 */
+	f25519_mul__distinct(z11, a, c);	/* 11 */
+	f25519_sqr(a, z11);			/* 22 */
+	f25519_mul__distinct(b, a, c);		/* 2^5 - 1 */
+	sqr_n(a, b, 5);
+	f25519_mul__distinct(c, a, b);		/* 2^10 - 1 */
+	sqr_n(a, c, 10);
+	f25519_mul__distinct(b, a, c);		/* 2^20 - 1 */
+	sqr_n(a, b, 20);
+	f25519_mul__distinct(r, a, b);		/* 2^40 - 1 */
+	sqr_n(a, r, 10);
+	f25519_mul__distinct(b, a, c);		/* 2^50 - 1 */
+	sqr_n(a, b, 50);
+	f25519_mul__distinct(c, a, b);		/* 2^100 - 1 */
+	sqr_n(a, c, 100);
+	f25519_mul__distinct(r, a, c);		/* 2^200 - 1 */
+	sqr_n(a, r, 50);
+	f25519_mul__distinct(r, a, b);		/* 2^250 - 1 */
+}
 
-	/* 1 */
-	f25519_mul__distinct(s, r, r);
-	f25519_mul__distinct(r, s, x);
+void f25519_inv__distinct(uint8_t *r, const uint8_t *x)
+{
+	uint8_t s[F25519_SIZE];
+	uint8_t z11[F25519_SIZE];
 
-	/* 1 */
-	f25519_mul__distinct(s, r, r);
-	f25519_mul__distinct(r, s, x);
+	/* This is a prime field, so by Fermat's little theorem:
+	 *
+	 *     x^(p-1) = 1 mod p
+	 *
+	 * Therefore, raise to (p-2) = 2^255-21 to get a multiplicative
+	 * inverse.
+	 *
+	 * We use the usual addition chain: 254 squarings and 11
+	 * multiplications, with (2^250-1) * 2^5 + 11 = 2^255-21.
+	 */
+	pow250(s, z11, x);
+	sqr_n(s, s, 5);
+	f25519_mul__distinct(r, s, z11);
 }
 
 #ifdef FULL_C25519_CODE
@@ -277,33 +329,14 @@ void f25519_inv(uint8_t *r, const uint8_t *x)
 }
 #endif
 
-/* Raise x to the power of (p-5)/8 = 2^252-3, using s for temporary
- * storage.
- */
-static void exp2523(uint8_t *r, const uint8_t *x, uint8_t *s)
+/* Raise x to the power of (p-5)/8 = 2^252-3 = (2^250-1) * 4 + 1 */
+static void exp2523(uint8_t *r, const uint8_t *x)
 {
-	int i;
-
-	/* This number is a 252-bit number with the binary expansion:
-	 *
-	 *     111111... 01
-	 */
-
-	/* 1 1 */
-	f25519_mul__distinct(r, x, x);
-	f25519_mul__distinct(s, r, x);
-
-	/* 1 x 248 */
-	for (i = 0; i < 248; i++) {
-		f25519_mul__distinct(r, s, s);
-		f25519_mul__distinct(s, r, x);
-	}
-
-	/* 0 */
-	f25519_mul__distinct(r, s, s);
+	uint8_t s[F25519_SIZE];
+	uint8_t z11[F25519_SIZE];
 
-	/* 1 */
-	f25519_mul__distinct(s, r, r);
+	pow250(s, z11, x);
+	sqr_n(s, s, 2);
 	f25519_mul__distinct(r, s, x);
 }
 
@@ -316,10 +349,10 @@ void f25519_sqrt(uint8_t *r, const uint8_t *a)
 
 	/* v = (2a)^((p-5)/8) [x = 2a] */
 	f25519_mul_c(x, a, 2);
-	exp2523(v, x, y);
+	exp2523(v, x);
 
 	/* i = 2av^2 - 1 */
-	f25519_mul__distinct(y, v, v);
+	f25519_sqr(y, v);
 	f25519_mul__distinct(i, x, y);
 	f25519_load(y, 1);
 	f25519_sub(i, i, y);
@@ -328,3 +361,4 @@ void f25519_sqrt(uint8_t *r, const uint8_t *a)
 	f25519_mul__distinct(x, v, a);
 	f25519_mul__distinct(r, x, i);
 }
+#endif
@@ -23,6 +23,30 @@
  */
 #define F25519_SIZE  32
 
+/* Backend used for multiplication, inversion and square roots. The
+ * byte-string representation above is the same for all of them; limb
+ * backends unpack elements internally.
+ *
+ *     F25519_BACKEND_BYTES   schoolbook over bytes, best on 8-bit parts
+ *     F25519_BACKEND_LIMB32  ten 25/26-bit limbs with 32x32->64 products,
+ *                            for 32-bit parts (Cortex-M, Xtensa, ...)
+ *     F25519_BACKEND_LIMB64  five 51-bit limbs with 64x64->128 products,
+ *                            for 64-bit hosts whose compiler has __int128
+ */
+#define F25519_BACKEND_BYTES   0
+#define F25519_BACKEND_LIMB32  1
+#define F25519_BACKEND_LIMB64  2
+
+#ifndef F25519_BACKEND
+#if defined(__AVR__)
+#define F25519_BACKEND  F25519_BACKEND_BYTES
+#elif defined(__SIZEOF_INT128__)
+#define F25519_BACKEND  F25519_BACKEND_LIMB64
+#else
+#define F25519_BACKEND  F25519_BACKEND_LIMB32
+#endif
+#endif
+
 /* Identity constants */
 #ifdef FULL_C25519_CODE
 extern const uint8_t f25519_zero[F25519_SIZE];
@@ -71,6 +95,11 @@ void f25519_mul(uint8_t *r, const uint8_t *a, const uint8_t *b);
 #endif
 void f25519_mul__distinct(uint8_t *r, const uint8_t *a, const uint8_t *b);
 
+/* Square a field point. The two pointers are not required to be
+ * distinct. Cheaper than f25519_mul__distinct(r, a, a) in all backends.
+ */
+void f25519_sqr(uint8_t *r, const uint8_t *a);
+
 /* Multiply a point by a small constant. The two pointers are not
  * required to be distinct.
  *
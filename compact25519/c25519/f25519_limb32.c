@@ -0,0 +1,373 @@
+/* Arithmetic mod p = 2^255-19, 32-bit limb backend
+ *
+ * This file is in the public domain.
+ */
+
+#include "f25519.h"
+
+#if F25519_BACKEND == F25519_BACKEND_LIMB32
+
+/* Inside this backend, a field element is held in ten signed limbs of
+ * alternately 26 and 25 bits (radix 2^25.5), as in the ref10 code:
+ *
+ *     x = h[0] + h[1] 2^26 + h[2] 2^51 + h[3] 2^77 + ... + h[9] 2^230
+ *
+ * Products of two limbs fit in 64 bits, so a multiplication is 100
+ * 32x32->64 multiplies instead of 1024 byte products. Elements are
+ * converted from and to the 32-byte form at the API boundary. All
+ * operations are constant time.
+ */
+typedef int32_t limb25519[10];
+
+static uint32_t load24(const uint8_t *x)
+{
+	return ((uint32_t)x[0]) |
+	       (((uint32_t)x[1]) << 8) |
+	       (((uint32_t)x[2]) << 16);
+}
+
+static uint32_t load32(const uint8_t *x)
+{
+	return load24(x) | (((uint32_t)x[3]) << 24);
+}
+
+static void store32(uint8_t *x, uint32_t v)
+{
+	x[0] = v;
+	x[1] = v >> 8;
+	x[2] = v >> 16;
+	x[3] = v >> 24;
+}
+
+/* Signed carry propagation. On input, |t[0]| < 2^63 and |t[i]| < 2^62.
+ * On output, even limbs are below 1.1 * 2^25 and odd limbs below
+ * 1.1 * 2^24 in absolute value.
+ */
+static void limbs_carry(limb25519 h, int64_t *t)
+{
+	static const uint8_t order[12] = {0, 4, 1, 5, 2, 6, 3, 7, 4, 8, 9, 0};
+	int i;
+
+	for (i = 0; i < 12; i++) {
+		const int k = order[i];
+		const int bits = (k & 1) ? 25 : 26;
+		const int64_t c = (t[k] + ((int64_t)1 << (bits - 1))) >> bits;
+
+		t[k] -= c * ((int64_t)1 << bits);
+		if (k == 9)
+			t[0] += c * 19;
+		else
+			t[k + 1] += c;
+	}
+
+	for (i = 0; i < 10; i++)
+		h[i] = t[i];
+}
+
+/* Unpack a 32-byte element. Bit 255 is folded back in as 19, so any
+ * 256-bit string (including un-normalized values up to 2p) is accepted.
+ */
+static void limbs_load(limb25519 h, const uint8_t *s)
+{
+	int64_t t[10];
+
+	t[0] = load32(s) + 19 * (int64_t)(s[31] >> 7);
+	t[1] = ((int64_t)load24(s + 4)) << 6;
+	t[2] = ((int64_t)load24(s + 7)) << 5;
+	t[3] = ((int64_t)load24(s + 10)) << 3;
+	t[4] = ((int64_t)load24(s + 13)) << 2;
+	t[5] = load32(s + 16);
+	t[6] = ((int64_t)load24(s + 20)) << 7;
+	t[7] = ((int64_t)load24(s + 23)) << 5;
+	t[8] = ((int64_t)load24(s + 26)) << 4;
+	t[9] = ((int64_t)(load24(s + 29) & 0x7fffff)) << 2;
+	limbs_carry(h, t);
+}
+
+/* Pack into 32 bytes, fully reduced (0 <= x < p) */
+static void limbs_store(uint8_t *s, const limb25519 h)
+{
+	int32_t t[10];
+	int32_t q;
+	int i;
+
+	memcpy(t, h, sizeof(t));
+
+	/* q = -1 if h is negative, 0 otherwise (after adding 19) */
+	q = (19 * t[9] + (((int32_t)1) << 24)) >> 25;
+	for (i = 0; i < 5; i++) {
+		q = (q + t[2 * i]) >> 26;
+		q = (q + t[2 * i + 1]) >> 25;
+	}
+
+	q *= 19;
+	for (i = 0; i < 5; i++) {
+		t[2 * i] += q;
+		q = t[2 * i] >> 26;
+		t[2 * i] -= q * ((int32_t)1 << 26);
+		t[2 * i + 1] += q;
+		q = t[2 * i + 1] >> 25;
+		t[2 * i + 1] -= q * ((int32_t)1 << 25);
+	}
+
+	store32(s + 0, ((uint32_t)t[0] >> 0) | ((uint32_t)t[1] << 26));
+	store32(s + 4, ((uint32_t)t[1] >> 6) | ((uint32_t)t[2] << 19));
+	store32(s + 8, ((uint32_t)t[2] >> 13) | ((uint32_t)t[3] << 13));
+	store32(s + 12, ((uint32_t)t[3] >> 19) | ((uint32_t)t[4] << 6));
+	store32(s + 16, ((uint32_t)t[5] >> 0) | ((uint32_t)t[6] << 25));
+	store32(s + 20, ((uint32_t)t[6] >> 7) | ((uint32_t)t[7] << 19));
+	store32(s + 24, ((uint32_t)t[7] >> 13) | ((uint32_t)t[8] << 12));
+	store32(s + 28, ((uint32_t)t[8] >> 20) | ((uint32_t)t[9] << 6));
+}
+
+static void limbs_mul(limb25519 h, const limb25519 f, const limb25519 g)
+{
+	const int32_t f0 = f[0], f1 = f[1], f2 = f[2], f3 = f[3], f4 = f[4];
+	const int32_t f5 = f[5], f6 = f[6], f7 = f[7], f8 = f[8], f9 = f[9];
+	const int32_t g0 = g[0], g1 = g[1], g2 = g[2], g3 = g[3], g4 = g[4];
+	const int32_t g5 = g[5], g6 = g[6], g7 = g[7], g8 = g[8], g9 = g[9];
+
+	/* Odd limbs of f carry an extra factor 2 when multiplied by odd
+	 * limbs of g. Wrapped-around terms are multiplied by 19.
+	 */
+	const int32_t F1 = f1 * 2, F3 = f3 * 2, F5 = f5 * 2;
+	const int32_t F7 = f7 * 2, F9 = f9 * 2;
+	const int32_t G1 = g1 * 19, G2 = g2 * 19, G3 = g3 * 19;
+	const int32_t G4 = g4 * 19, G5 = g5 * 19, G6 = g6 * 19;
+	const int32_t G7 = g7 * 19, G8 = g8 * 19, G9 = g9 * 19;
+	int64_t t[10];
+
+	t[0] = f0 * (int64_t)g0 + F1 * (int64_t)G9 + f2 * (int64_t)G8 +
+	       F3 * (int64_t)G7 + f4 * (int64_t)G6 + F5 * (int64_t)G5 +
+	       f6 * (int64_t)G4 + F7 * (int64_t)G3 + f8 * (int64_t)G2 +
+	       F9 * (int64_t)G1;
+	t[1] = f0 * (int64_t)g1 + f1 * (int64_t)g0 + f2 * (int64_t)G9 +
+	       f3 * (int64_t)G8 + f4 * (int64_t)G7 + f5 * (int64_t)G6 +
+	       f6 * (int64_t)G5 + f7 * (int64_t)G4 + f8 * (int64_t)G3 +
+	       f9 * (int64_t)G2;
+	t[2] = f0 * (int64_t)g2 + F1 * (int64_t)g1 + f2 * (int64_t)g0 +
+	       F3 * (int64_t)G9 + f4 * (int64_t)G8 + F5 * (int64_t)G7 +
+	       f6 * (int64_t)G6 + F7 * (int64_t)G5 + f8 * (int64_t)G4 +
+	       F9 * (int64_t)G3;
+	t[3] = f0 * (int64_t)g3 + f1 * (int64_t)g2 + f2 * (int64_t)g1 +
+	       f3 * (int64_t)g0 + f4 * (int64_t)G9 + f5 * (int64_t)G8 +
+	       f6 * (int64_t)G7 + f7 * (int64_t)G6 + f8 * (int64_t)G5 +
+	       f9 * (int64_t)G4;
+	t[4] = f0 * (int64_t)g4 + F1 * (int64_t)g3 + f2 * (int64_t)g2 +
+	       F3 * (int64_t)g1 + f4 * (int64_t)g0 + F5 * (int64_t)G9 +
+	       f6 * (int64_t)G8 + F7 * (int64_t)G7 + f8 * (int64_t)G6 +
+	       F9 * (int64_t)G5;
+	t[5] = f0 * (int64_t)g5 + f1 * (int64_t)g4 + f2 * (int64_t)g3 +
+	       f3 * (int64_t)g2 + f4 * (int64_t)g1 + f5 * (int64_t)g0 +
+	       f6 * (int64_t)G9 + f7 * (int64_t)G8 + f8 * (int64_t)G7 +
+	       f9 * (int64_t)G6;
+	t[6] = f0 * (int64_t)g6 + F1 * (int64_t)g5 + f2 * (int64_t)g4 +
+	       F3 * (int64_t)g3 + f4 * (int64_t)g2 + F5 * (int64_t)g1 +
+	       f6 * (int64_t)g0 + F7 * (int64_t)G9 + f8 * (int64_t)G8 +
+	       F9 * (int64_t)G7;
+	t[7] = f0 * (int64_t)g7 + f1 * (int64_t)g6 + f2 * (int64_t)g5 +
+	       f3 * (int64_t)g4 + f4 * (int64_t)g3 + f5 * (int64_t)g2 +
+	       f6 * (int64_t)g1 + f7 * (int64_t)g0 + f8 * (int64_t)G9 +
+	       f9 * (int64_t)G8;
+	t[8] = f0 * (int64_t)g8 + F1 * (int64_t)g7 + f2 * (int64_t)g6 +
+	       F3 * (int64_t)g5 + f4 * (int64_t)g4 + F5 * (int64_t)g3 +
+	       f6 * (int64_t)g2 + F7 * (int64_t)g1 + f8 * (int64_t)g0 +
+	       F9 * (int64_t)G9;
+	t[9] = f0 * (int64_t)g9 + f1 * (int64_t)g8 + f2 * (int64_t)g7 +
+	       f3 * (int64_t)g6 + f4 * (int64_t)g5 + f5 * (int64_t)g4 +
+	       f6 * (int64_t)g3 + f7 * (int64_t)g2 + f8 * (int64_t)g1 +
+	       f9 * (int64_t)g0;
+
+	limbs_carry(h, t);
+}
+
+/* Squaring shares the cross products: 55 multiplies instead of 100 */
+static void limbs_sq(limb25519 h, const limb25519 f)
+{
+	const int32_t f0 = f[0], f1 = f[1], f2 = f[2], f3 = f[3], f4 = f[4];
+	const int32_t f5 = f[5], f6 = f[6], f7 = f[7], f8 = f[8], f9 = f[9];
+	const int32_t f0_2 = f0 * 2, f1_2 = f1 * 2, f2_2 = f2 * 2;
+	const int32_t f3_2 = f3 * 2, f4_2 = f4 * 2, f5_2 = f5 * 2;
+	const int32_t f6_2 = f6 * 2, f7_2 = f7 * 2;
+	const int32_t f5_38 = f5 * 38, f6_19 = f6 * 19, f7_38 = f7 * 38;
+	const int32_t f8_19 = f8 * 19, f9_38 = f9 * 38;
+	int64_t t[10];
+
+	t[0] = f0 * (int64_t)f0 + f1_2 * (int64_t)f9_38 +
+	       f2_2 * (int64_t)f8_19 + f3_2 * (int64_t)f7_38 +
+	       f4_2 * (int64_t)f6_19 + f5 * (int64_t)f5_38;
+	t[1] = f0_2 * (int64_t)f1 + f2 * (int64_t)f9_38 +
+	       f3_2 * (int64_t)f8_19 + f4 * (int64_t)f7_38 +
+	       f5_2 * (int64_t)f6_19;
+	t[2] = f0_2 * (int64_t)f2 + f1_2 * (int64_t)f1 +
+	       f3_2 * (int64_t)f9_38 + f4_2 * (int64_t)f8_19 +
+	       f5_2 * (int64_t)f7_38 + f6 * (int64_t)f6_19;
+	t[3] = f0_2 * (int64_t)f3 + f1_2 * (int64_t)f2 +
+	       f4 * (int64_t)f9_38 + f5_2 * (int64_t)f8_19 +
+	       f6 * (int64_t)f7_38;
+	t[4] = f0_2 * (int64_t)f4 + f1_2 * (int64_t)f3_2 +
+	       f2 * (int64_t)f2 + f5_2 * (int64_t)f9_38 +
+	       f6_2 * (int64_t)f8_19 + f7 * (int64_t)f7_38;
+	t[5] = f0_2 * (int64_t)f5 + f1_2 * (int64_t)f4 +
+	       f2_2 * (int64_t)f3 + f6 * (int64_t)f9_38 +
+	       f7_2 * (int64_t)f8_19;
+	t[6] = f0_2 * (int64_t)f6 + f1_2 * (int64_t)f5_2 +
+	       f2_2 * (int64_t)f4 + f3_2 * (int64_t)f3 +
+	       f7_2 * (int64_t)f9_38 + f8 * (int64_t)f8_19;
+	t[7] = f0_2 * (int64_t)f7 + f1_2 * (int64_t)f6 +
+	       f2_2 * (int64_t)f5 + f3_2 * (int64_t)f4 +
+	       f8 * (int64_t)f9_38;
+	t[8] = f0_2 * (int64_t)f8 + f1_2 * (int64_t)f7_2 +
+	       f2_2 * (int64_t)f6 + f3_2 * (int64_t)f5_2 +
+	       f4 * (int64_t)f4 + f9 * (int64_t)f9_38;
+	t[9] = f0_2 * (int64_t)f9 + f1_2 * (int64_t)f8 +
+	       f2_2 * (int64_t)f7 + f3_2 * (int64_t)f6 +
+	       f4_2 * (int64_t)f5;
+
+	limbs_carry(h, t);
+}
+
+void f25519_mul__distinct(uint8_t *r, const uint8_t *a, const uint8_t *b)
+{
+	limb25519 x;
+	limb25519 y;
+
+	limbs_load(x, a);
+	limbs_load(y, b);
+	limbs_mul(x, x, y);
+	limbs_store(r, x);
+}
+
+#ifdef FULL_C25519_CODE
+void f25519_mul(uint8_t *r, const uint8_t *a, const uint8_t *b)
+{
+	uint8_t tmp[F25519_SIZE];
+
+	f25519_mul__distinct(tmp, a, b);
+	f25519_copy(r, tmp);
+}
+#endif
+
+void f25519_mul_c(uint8_t *r, const uint8_t *a, uint32_t b)
+{
+	limb25519 x;
+	int64_t t[10];
+	int i;
+
+	limbs_load(x, a);
+	for (i = 0; i < 10; i++)
+		t[i] = x[i] * (int64_t)b;
+
+	limbs_carry(x, t);
+	limbs_store(r, x);
+}
+
+void f25519_sqr(uint8_t *r, const uint8_t *a)
+{
+	limb25519 x;
+
+	limbs_load(x, a);
+	limbs_sq(x, x);
+	limbs_store(r, x);
+}
+
+/* Square n times */
+static void limbs_sq_n(limb25519 h, const limb25519 f, int n)
+{
+	limbs_sq(h, f);
+	while (--n)
+		limbs_sq(h, h);
+}
+
+/* Compute r = x^(2^250-1) and z11 = x^11, the common prefix of the
+ * addition chains for (p-2) and (p-5)/8.
+ */
+static void limbs_pow250(limb25519 r, limb25519 z11, const limb25519 x)
+{
+	limb25519 a;
+	limb25519 b;
+	limb25519 c;
+
+	limbs_sq(a, x);				/* 2 */
+	limbs_sq_n(b, a, 2);			/* 8 */
+	limbs_mul(c, b, x);			/* 9 */
+	limbs_mul(z11, a, c);			/* 11 */
+	limbs_sq(a, z11);			/* 22 */
+	limbs_mul(b, a, c);			/* 2^5 - 1 */
+	limbs_sq_n(a, b, 5);
+	limbs_mul(c, a, b);			/* 2^10 - 1 */
+	limbs_sq_n(a, c, 10);
+	limbs_mul(b, a, c);			/* 2^20 - 1 */
+	limbs_sq_n(a, b, 20);
+	limbs_mul(a, a, b);			/* 2^40 - 1 */
+	limbs_sq_n(a, a, 10);
+	limbs_mul(b, a, c);			/* 2^50 - 1 */
+	limbs_sq_n(a, b, 50);
+	limbs_mul(c, a, b);			/* 2^100 - 1 */
+	limbs_sq_n(a, c, 100);
+	limbs_mul(a, a, c);			/* 2^200 - 1 */
+	limbs_sq_n(a, a, 50);
+	limbs_mul(r, a, b);			/* 2^250 - 1 */
+}
+
+void f25519_inv__distinct(uint8_t *r, const uint8_t *x)
+{
+	limb25519 a;
+	limb25519 s;
+	limb25519 z11;
+
+	/* Fermat: raise to (p-2) = 2^255-21 = (2^250-1) * 2^5 + 11, in
+	 * 254 squarings and 11 multiplications.
+	 */
+	limbs_load(a, x);
+	limbs_pow250(s, z11, a);
+	limbs_sq_n(s, s, 5);
+	limbs_mul(s, s, z11);
+	limbs_store(r, s);
+}
+
+#ifdef FULL_C25519_CODE
+void f25519_inv(uint8_t *r, const uint8_t *x)
+{
+	uint8_t tmp[F25519_SIZE];
+
+	f25519_inv__distinct(tmp, x);
+	f25519_copy(r, tmp);
+}
+#endif
+
+/* Raise x to the power of (p-5)/8 = 2^252-3 = (2^250-1) * 4 + 1 */
+static void limbs_exp2523(limb25519 r, const limb25519 x)
+{
+	limb25519 z11;
+
+	limbs_pow250(r, z11, x);
+	limbs_sq_n(r, r, 2);
+	limbs_mul(r, r, x);
+}
+
+void f25519_sqrt(uint8_t *r, const uint8_t *a)
+{
+	limb25519 v;
+	limb25519 i;
+	limb25519 x;
+	limb25519 y;
+	int k;
+
+	/* v = (2a)^((p-5)/8) [x = 2a] */
+	limbs_load(y, a);
+	for (k = 0; k < 10; k++)
+		x[k] = y[k] * 2;
+	limbs_exp2523(v, x);
+
+	/* i = 2av^2 - 1 */
+	limbs_sq(i, v);
+	limbs_mul(i, x, i);
+	i[0] -= 1;
+
+	/* r = avi */
+	limbs_mul(x, v, y);
+	limbs_mul(x, x, i);
+	limbs_store(r, x);
+}
+#endif
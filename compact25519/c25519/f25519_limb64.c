@@ -0,0 +1,336 @@
+/* Arithmetic mod p = 2^255-19, 64-bit limb backend
+ *
+ * This file is in the public domain.
+ */
+
+#include "f25519.h"
+
+#if F25519_BACKEND == F25519_BACKEND_LIMB64
+
+/* Inside this backend, a field element is held in five unsigned limbs
+ * of 51 bits (radix 2^51):
+ *
+ *     x = h[0] + h[1] 2^51 + h[2] 2^102 + h[3] 2^153 + h[4] 2^204
+ *
+ * A multiplication is 25 64x64->128 multiplies, which is what 64-bit
+ * hosts are built for. Elements are converted from and to the 32-byte
+ * form at the API boundary. All operations are constant time.
+ */
+typedef uint64_t limb25519[5];
+typedef unsigned __int128 limb25519_wide;
+
+#define LIMB_MASK  ((((uint64_t)1) << 51) - 1)
+
+/* Not load64()/store64(): sha512.c, which shares the translation unit,
+ * already has big-endian helpers with those names.
+ */
+static uint64_t load_le64(const uint8_t *x)
+{
+	uint64_t r = 0;
+	int i;
+
+	for (i = 7; i >= 0; i--)
+		r = (r << 8) | x[i];
+
+	return r;
+}
+
+static void store_le64(uint8_t *x, uint64_t v)
+{
+	int i;
+
+	for (i = 0; i < 8; i++) {
+		x[i] = v;
+		v >>= 8;
+	}
+}
+
+/* Carry propagation from 128-bit column sums. On output, h[1..4] are
+ * below 2^51 and h[0] below 2^51 + 2^20.
+ */
+static void limbs_carry(limb25519 h, limb25519_wide *t)
+{
+	limb25519_wide c;
+
+	c = t[0] >> 51; t[1] += c; h[0] = (uint64_t)t[0] & LIMB_MASK;
+	c = t[1] >> 51; t[2] += c; h[1] = (uint64_t)t[1] & LIMB_MASK;
+	c = t[2] >> 51; t[3] += c; h[2] = (uint64_t)t[2] & LIMB_MASK;
+	c = t[3] >> 51; t[4] += c; h[3] = (uint64_t)t[3] & LIMB_MASK;
+	c = t[4] >> 51;            h[4] = (uint64_t)t[4] & LIMB_MASK;
+
+	c = h[0] + c * 19;
+	h[0] = (uint64_t)c & LIMB_MASK;
+	h[1] += (uint64_t)(c >> 51);
+}
+
+/* Carry propagation within the limbs, for values with limbs below
+ * 2^63. Leaves the same bounds as limbs_carry().
+ */
+static void limbs_reduce(limb25519 h)
+{
+	uint64_t c;
+
+	c = h[0] >> 51; h[0] &= LIMB_MASK; h[1] += c;
+	c = h[1] >> 51; h[1] &= LIMB_MASK; h[2] += c;
+	c = h[2] >> 51; h[2] &= LIMB_MASK; h[3] += c;
+	c = h[3] >> 51; h[3] &= LIMB_MASK; h[4] += c;
+	c = h[4] >> 51; h[4] &= LIMB_MASK; h[0] += c * 19;
+}
+
+/* Unpack a 32-byte element. Bit 255 is folded back in as 19, so any
+ * 256-bit string (including un-normalized values up to 2p) is accepted.
+ */
+static void limbs_load(limb25519 h, const uint8_t *s)
+{
+	h[0] = (load_le64(s) & LIMB_MASK) + 19 * (uint64_t)(s[31] >> 7);
+	h[1] = (load_le64(s + 6) >> 3) & LIMB_MASK;
+	h[2] = (load_le64(s + 12) >> 6) & LIMB_MASK;
+	h[3] = (load_le64(s + 19) >> 1) & LIMB_MASK;
+	h[4] = (load_le64(s + 24) >> 12) & LIMB_MASK;
+}
+
+/* Pack into 32 bytes, fully reduced (0 <= x < p) */
+static void limbs_store(uint8_t *s, const limb25519 h)
+{
+	uint64_t t[5];
+	uint64_t q;
+
+	memcpy(t, h, sizeof(t));
+	limbs_reduce(t);
+	limbs_reduce(t);
+
+	/* Now t < 2^255 + 19. q = 1 if t >= p, 0 otherwise */
+	q = (t[0] + 19) >> 51;
+	q = (t[1] + q) >> 51;
+	q = (t[2] + q) >> 51;
+	q = (t[3] + q) >> 51;
+	q = (t[4] + q) >> 51;
+
+	/* Subtract p if necessary: add 19 and drop bit 255 */
+	t[0] += 19 * q;
+	t[1] += t[0] >> 51; t[0] &= LIMB_MASK;
+	t[2] += t[1] >> 51; t[1] &= LIMB_MASK;
+	t[3] += t[2] >> 51; t[2] &= LIMB_MASK;
+	t[4] += t[3] >> 51; t[3] &= LIMB_MASK;
+	t[4] &= LIMB_MASK;
+
+	store_le64(s + 0, t[0] | (t[1] << 51));
+	store_le64(s + 8, (t[1] >> 13) | (t[2] << 38));
+	store_le64(s + 16, (t[2] >> 26) | (t[3] << 25));
+	store_le64(s + 24, (t[3] >> 39) | (t[4] << 12));
+}
+
+/* Inputs may have limbs up to 2^54 */
+static void limbs_mul(limb25519 h, const limb25519 f, const limb25519 g)
+{
+	const uint64_t f0 = f[0], f1 = f[1], f2 = f[2], f3 = f[3], f4 = f[4];
+	const uint64_t g0 = g[0], g1 = g[1], g2 = g[2], g3 = g[3], g4 = g[4];
+
+	/* Wrapped-around terms are multiplied by 19 */
+	const uint64_t G1 = g1 * 19, G2 = g2 * 19, G3 = g3 * 19;
+	const uint64_t G4 = g4 * 19;
+	limb25519_wide t[5];
+
+	t[0] = (limb25519_wide)f0 * g0 + (limb25519_wide)f1 * G4 +
+	       (limb25519_wide)f2 * G3 + (limb25519_wide)f3 * G2 +
+	       (limb25519_wide)f4 * G1;
+	t[1] = (limb25519_wide)f0 * g1 + (limb25519_wide)f1 * g0 +
+	       (limb25519_wide)f2 * G4 + (limb25519_wide)f3 * G3 +
+	       (limb25519_wide)f4 * G2;
+	t[2] = (limb25519_wide)f0 * g2 + (limb25519_wide)f1 * g1 +
+	       (limb25519_wide)f2 * g0 + (limb25519_wide)f3 * G4 +
+	       (limb25519_wide)f4 * G3;
+	t[3] = (limb25519_wide)f0 * g3 + (limb25519_wide)f1 * g2 +
+	       (limb25519_wide)f2 * g1 + (limb25519_wide)f3 * g0 +
+	       (limb25519_wide)f4 * G4;
+	t[4] = (limb25519_wide)f0 * g4 + (limb25519_wide)f1 * g3 +
+	       (limb25519_wide)f2 * g2 + (limb25519_wide)f3 * g1 +
+	       (limb25519_wide)f4 * g0;
+
+	limbs_carry(h, t);
+}
+
+/* Squaring shares the cross products: 15 multiplies instead of 25 */
+static void limbs_sq(limb25519 h, const limb25519 f)
+{
+	const uint64_t f0 = f[0], f1 = f[1], f2 = f[2], f3 = f[3], f4 = f[4];
+	const uint64_t f0_2 = f0 * 2, f1_2 = f1 * 2;
+	const uint64_t f1_38 = f1 * 38, f2_38 = f2 * 38;
+	const uint64_t f3_19 = f3 * 19, f3_38 = f3 * 38, f4_19 = f4 * 19;
+	limb25519_wide t[5];
+
+	t[0] = (limb25519_wide)f0 * f0 + (limb25519_wide)f1_38 * f4 +
+	       (limb25519_wide)f2_38 * f3;
+	t[1] = (limb25519_wide)f0_2 * f1 + (limb25519_wide)f2_38 * f4 +
+	       (limb25519_wide)f3_19 * f3;
+	t[2] = (limb25519_wide)f0_2 * f2 + (limb25519_wide)f1 * f1 +
+	       (limb25519_wide)f3_38 * f4;
+	t[3] = (limb25519_wide)f0_2 * f3 + (limb25519_wide)f1_2 * f2 +
+	       (limb25519_wide)f4_19 * f4;
+	t[4] = (limb25519_wide)f0_2 * f4 + (limb25519_wide)f1_2 * f3 +
+	       (limb25519_wide)f2 * f2;
+
+	limbs_carry(h, t);
+}
+
+void f25519_select(uint8_t *dst,
+		   const uint8_t *zero, const uint8_t *one,
+		   uint8_t condition)
+{
+	const uint64_t mask = -(uint64_t)condition;
+	int i;
+
+	for (i = 0; i < F25519_SIZE; i += 8) {
+		const uint64_t z = load_le64(zero + i);
+		const uint64_t o = load_le64(one + i);
+
+		store_le64(dst + i, z ^ (mask & (o ^ z)));
+	}
+}
+
+void f25519_mul__distinct(uint8_t *r, const uint8_t *a, const uint8_t *b)
+{
+	limb25519 x;
+	limb25519 y;
+
+	limbs_load(x, a);
+	limbs_load(y, b);
+	limbs_mul(x, x, y);
+	limbs_store(r, x);
+}
+
+#ifdef FULL_C25519_CODE
+void f25519_mul(uint8_t *r, const uint8_t *a, const uint8_t *b)
+{
+	uint8_t tmp[F25519_SIZE];
+
+	f25519_mul__distinct(tmp, a, b);
+	f25519_copy(r, tmp);
+}
+#endif
+
+void f25519_mul_c(uint8_t *r, const uint8_t *a, uint32_t b)
+{
+	limb25519 x;
+	limb25519_wide t[5];
+	int i;
+
+	limbs_load(x, a);
+	for (i = 0; i < 5; i++)
+		t[i] = (limb25519_wide)x[i] * b;
+
+	limbs_carry(x, t);
+	limbs_store(r, x);
+}
+
+void f25519_sqr(uint8_t *r, const uint8_t *a)
+{
+	limb25519 x;
+
+	limbs_load(x, a);
+	limbs_sq(x, x);
+	limbs_store(r, x);
+}
+
+/* Square n times */
+static void limbs_sq_n(limb25519 h, const limb25519 f, int n)
+{
+	limbs_sq(h, f);
+	while (--n)
+		limbs_sq(h, h);
+}
+
+/* Compute r = x^(2^250-1) and z11 = x^11, the common prefix of the
+ * addition chains for (p-2) and (p-5)/8.
+ */
+static void limbs_pow250(limb25519 r, limb25519 z11, const limb25519 x)
+{
+	limb25519 a;
+	limb25519 b;
+	limb25519 c;
+
+	limbs_sq(a, x);				/* 2 */
+	limbs_sq_n(b, a, 2);			/* 8 */
+	limbs_mul(c, b, x);			/* 9 */
+	limbs_mul(z11, a, c);			/* 11 */
+	limbs_sq(a, z11);			/* 22 */
+	limbs_mul(b, a, c);			/* 2^5 - 1 */
+	limbs_sq_n(a, b, 5);
+	limbs_mul(c, a, b);			/* 2^10 - 1 */
+	limbs_sq_n(a, c, 10);
+	limbs_mul(b, a, c);			/* 2^20 - 1 */
+	limbs_sq_n(a, b, 20);
+	limbs_mul(a, a, b);			/* 2^40 - 1 */
+	limbs_sq_n(a, a, 10);
+	limbs_mul(b, a, c);			/* 2^50 - 1 */
+	limbs_sq_n(a, b, 50);
+	limbs_mul(c, a, b);			/* 2^100 - 1 */
+	limbs_sq_n(a, c, 100);
+	limbs_mul(a, a, c);			/* 2^200 - 1 */
+	limbs_sq_n(a, a, 50);
+	limbs_mul(r, a, b);			/* 2^250 - 1 */
+}
+
+void f25519_inv__distinct(uint8_t *r, const uint8_t *x)
+{
+	limb25519 a;
+	limb25519 s;
+	limb25519 z11;
+
+	/* Fermat: raise to (p-2) = 2^255-21 = (2^250-1) * 2^5 + 11, in
+	 * 254 squarings and 11 multiplications.
+	 */
+	limbs_load(a, x);
+	limbs_pow250(s, z11, a);
+	limbs_sq_n(s, s, 5);
+	limbs_mul(s, s, z11);
+	limbs_store(r, s);
+}
+
+#ifdef FULL_C25519_CODE
+void f25519_inv(uint8_t *r, const uint8_t *x)
+{
+	uint8_t tmp[F25519_SIZE];
+
+	f25519_inv__distinct(tmp, x);
+	f25519_copy(r, tmp);
+}
+#endif
+
+/* Raise x to the power of (p-5)/8 = 2^252-3 = (2^250-1) * 4 + 1 */
+static void limbs_exp2523(limb25519 r, const limb25519 x)
+{
+	limb25519 z11;
+
+	limbs_pow250(r, z11, x);
+	limbs_sq_n(r, r, 2);
+	limbs_mul(r, r, x);
+}
+
+void f25519_sqrt(uint8_t *r, const uint8_t *a)
+{
+	limb25519 v;
+	limb25519 i;
+	limb25519 x;
+	limb25519 y;
+	int k;
+
+	/* v = (2a)^((p-5)/8) [x = 2a] */
+	limbs_load(y, a);
+	for (k = 0; k < 5; k++)
+		x[k] = y[k] * 2;
+	limbs_exp2523(v, x);
+
+	/* i = 2av^2 - 1, computed as 2av^2 + (2p - 1) to stay unsigned */
+	limbs_sq(i, v);
+	limbs_mul(i, x, i);
+	i[0] += 0xfffffffffffdaULL - 1;
+	for (k = 1; k < 5; k++)
+		i[k] += 0xffffffffffffeULL;
+
+	/* r = avi */
+	limbs_mul(x, v, y);
+	limbs_mul(x, x, i);
+	limbs_store(r, x);
+}
+#endif
@@ -0,0 +1,364 @@
+/* Four-way arithmetic mod p = 2^255-19 for x86 with AVX2
+ *
+ * This file is in the public domain.
+ */
+
+#include "f25519x4.h"
+
+#if F25519_X4
+
+uint8_t f25519x4_available(void)
+{
+#ifdef __AVX2__
+	return 1;
+#else
+	return __builtin_cpu_supports("avx2") ? 1 : 0;
+#endif
+}
+
+static uint64_t x4_load24(const uint8_t *x)
+{
+	return ((uint64_t)x[0]) |
+	       (((uint64_t)x[1]) << 8) |
+	       (((uint64_t)x[2]) << 16);
+}
+
+static uint64_t x4_load32(const uint8_t *x)
+{
+	return x4_load24(x) | (((uint64_t)x[3]) << 24);
+}
+
+static void x4_store32(uint8_t *x, uint32_t v)
+{
+	x[0] = v;
+	x[1] = v >> 8;
+	x[2] = v >> 16;
+	x[3] = v >> 24;
+}
+
+/* Split a 32-byte element into uncarried limbs. Bit 255 is folded back
+ * in as 19.
+ */
+static void x4_split(uint64_t *t, const uint8_t *s)
+{
+	t[0] = x4_load32(s) + 19 * (uint64_t)(s[31] >> 7);
+	t[1] = x4_load24(s + 4) << 6;
+	t[2] = x4_load24(s + 7) << 5;
+	t[3] = x4_load24(s + 10) << 3;
+	t[4] = x4_load24(s + 13) << 2;
+	t[5] = x4_load32(s + 16);
+	t[6] = x4_load24(s + 20) << 7;
+	t[7] = x4_load24(s + 23) << 5;
+	t[8] = x4_load24(s + 26) << 4;
+	t[9] = (x4_load24(s + 29) & 0x7fffff) << 2;
+}
+
+/* Join carried limbs into 32 bytes, fully reduced (0 <= x < p). As
+ * limbs_store() in the 32-bit backend, but for unsigned limbs.
+ */
+static void x4_join(uint8_t *s, const uint64_t *h)
+{
+	int64_t t[10];
+	int64_t q;
+	int i;
+
+	for (i = 0; i < 10; i++)
+		t[i] = h[i];
+
+	/* q = 1 if h >= p, 0 otherwise */
+	q = (19 * t[9] + (((int64_t)1) << 24)) >> 25;
+	for (i = 0; i < 5; i++) {
+		q = (q + t[2 * i]) >> 26;
+		q = (q + t[2 * i + 1]) >> 25;
+	}
+
+	q *= 19;
+	for (i = 0; i < 5; i++) {
+		t[2 * i] += q;
+		q = t[2 * i] >> 26;
+		t[2 * i] -= q * ((int64_t)1 << 26);
+		t[2 * i + 1] += q;
+		q = t[2 * i + 1] >> 25;
+		t[2 * i + 1] -= q * ((int64_t)1 << 25);
+	}
+
+	x4_store32(s + 0, ((uint32_t)t[0] >> 0) | ((uint32_t)t[1] << 26));
+	x4_store32(s + 4, ((uint32_t)t[1] >> 6) | ((uint32_t)t[2] << 19));
+	x4_store32(s + 8, ((uint32_t)t[2] >> 13) | ((uint32_t)t[3] << 13));
+	x4_store32(s + 12, ((uint32_t)t[3] >> 19) | ((uint32_t)t[4] << 6));
+	x4_store32(s + 16, ((uint32_t)t[5] >> 0) | ((uint32_t)t[6] << 25));
+	x4_store32(s + 20, ((uint32_t)t[6] >> 7) | ((uint32_t)t[7] << 19));
+	x4_store32(s + 24, ((uint32_t)t[7] >> 13) | ((uint32_t)t[8] << 12));
+	x4_store32(s + 28, ((uint32_t)t[8] >> 20) | ((uint32_t)t[9] << 6));
+}
+
+/* Carry propagation, in the interleaved order of the ref10 code so that
+ * two chains run in parallel. Any 64-bit input is accepted; on output,
+ * even limbs are below 2^26 and odd limbs below 2^25, except for limbs
+ * 1 and 5, which may exceed that by the last carry (2^18 at most).
+ */
+#define X4_CARRY(t, k, bits) \
+	do { \
+		const __m256i c = _mm256_srli_epi64(t[k], bits); \
+		t[k] = _mm256_and_si256(t[k], \
+			_mm256_set1_epi64x((((int64_t)1) << (bits)) - 1)); \
+		t[(k) + 1] = _mm256_add_epi64(t[(k) + 1], c); \
+	} while (0)
+
+static F25519X4_TARGET void x4_carry(__m256i *h, __m256i *t)
+{
+	__m256i c;
+	int i;
+
+	X4_CARRY(t, 0, 26);
+	X4_CARRY(t, 4, 26);
+	X4_CARRY(t, 1, 25);
+	X4_CARRY(t, 5, 25);
+	X4_CARRY(t, 2, 26);
+	X4_CARRY(t, 6, 26);
+	X4_CARRY(t, 3, 25);
+	X4_CARRY(t, 7, 25);
+	X4_CARRY(t, 4, 26);
+	X4_CARRY(t, 8, 26);
+
+	/* 2^255 = 19: fold the top carry back in as 19 c = c + 2c + 16c */
+	c = _mm256_srli_epi64(t[9], 25);
+	t[9] = _mm256_and_si256(t[9], _mm256_set1_epi64x((1 << 25) - 1));
+	t[0] = _mm256_add_epi64(t[0], c);
+	t[0] = _mm256_add_epi64(t[0], _mm256_slli_epi64(c, 1));
+	t[0] = _mm256_add_epi64(t[0], _mm256_slli_epi64(c, 4));
+
+	X4_CARRY(t, 0, 26);
+
+	for (i = 0; i < 10; i++)
+		h[i] = t[i];
+}
+
+F25519X4_TARGET void f25519x4_gather(struct f25519x4 *r,
+				     const uint8_t *a0, const uint8_t *a1,
+				     const uint8_t *a2, const uint8_t *a3)
+{
+	uint64_t t[4][10];
+	__m256i v[10];
+	int i;
+
+	x4_split(t[0], a0);
+	x4_split(t[1], a1);
+	x4_split(t[2], a2);
+	x4_split(t[3], a3);
+
+	for (i = 0; i < 10; i++)
+		v[i] = _mm256_set_epi64x(t[3][i], t[2][i], t[1][i], t[0][i]);
+
+	x4_carry(r->v, v);
+}
+
+F25519X4_TARGET void f25519x4_scatter(uint8_t *r0, uint8_t *r1,
+				      uint8_t *r2, uint8_t *r3,
+				      const struct f25519x4 *a)
+{
+	uint64_t t[10][4];
+	uint64_t h[10];
+	uint8_t *const r[4] = {r0, r1, r2, r3};
+	__m256i v[10];
+	int i;
+	int j;
+
+	for (i = 0; i < 10; i++)
+		v[i] = a->v[i];
+
+	x4_carry(v, v);
+
+	for (i = 0; i < 10; i++)
+		_mm256_storeu_si256((__m256i *)t[i], v[i]);
+
+	for (j = 0; j < 4; j++) {
+		for (i = 0; i < 10; i++)
+			h[i] = t[i][j];
+
+		x4_join(r[j], h);
+	}
+}
+
+void f25519x4_split(f25519x4_limbs r, const uint8_t *a)
+{
+	static const uint8_t order[12] = {0, 4, 1, 5, 2, 6, 3, 7, 4, 8, 9, 0};
+	uint64_t t[10];
+	int i;
+
+	x4_split(t, a);
+
+	/* The same carries as x4_carry(), one lane at a time */
+	for (i = 0; i < 12; i++) {
+		const int k = order[i];
+		const int bits = (k & 1) ? 25 : 26;
+		const uint64_t c = t[k] >> bits;
+
+		t[k] &= (((uint64_t)1) << bits) - 1;
+		if (k == 9)
+			t[0] += c * 19;
+		else
+			t[k + 1] += c;
+	}
+
+	for (i = 0; i < 10; i++)
+		r[i] = t[i];
+}
+
+F25519X4_TARGET void f25519x4_load(struct f25519x4 *r, uint32_t c)
+{
+	int i;
+
+	r->v[0] = _mm256_set1_epi64x(c & 0x3ffffff);
+	r->v[1] = _mm256_set1_epi64x(c >> 26);
+
+	for (i = 2; i < 10; i++)
+		r->v[i] = _mm256_setzero_si256();
+}
+
+F25519X4_TARGET void f25519x4_select(struct f25519x4 *r,
+				     const struct f25519x4 *zero,
+				     const struct f25519x4 *one,
+				     const __m256i *mask)
+{
+	int i;
+
+	for (i = 0; i < 10; i++)
+		r->v[i] = _mm256_blendv_epi8(zero->v[i], one->v[i], *mask);
+}
+
+F25519X4_TARGET void f25519x4_select_limbs(struct f25519x4 *r,
+					    const struct f25519x4 *zero,
+					    const f25519x4_limbs one,
+					    const __m256i *mask)
+{
+	int i;
+
+	for (i = 0; i < 10; i++)
+		r->v[i] = _mm256_blendv_epi8(zero->v[i],
+					     _mm256_set1_epi64x(one[i]),
+					     *mask);
+}
+
+F25519X4_TARGET void f25519x4_add(struct f25519x4 *r,
+				  const struct f25519x4 *a,
+				  const struct f25519x4 *b)
+{
+	int i;
+
+	for (i = 0; i < 10; i++)
+		r->v[i] = _mm256_add_epi64(a->v[i], b->v[i]);
+}
+
+F25519X4_TARGET void f25519x4_sub(struct f25519x4 *r,
+				  const struct f25519x4 *a,
+				  const struct f25519x4 *b)
+{
+	/* a + 4p - b: 4p is above every limb of b, so lanes stay
+	 * non-negative.
+	 */
+	__m256i t[10];
+	int i;
+
+	for (i = 0; i < 10; i++) {
+		const int64_t p4 = (i == 0) ? 0xfffffb4 :
+				   (i & 1) ? 0x7fffffc : 0xffffffc;
+
+		t[i] = _mm256_sub_epi64(
+			_mm256_add_epi64(a->v[i], _mm256_set1_epi64x(p4)),
+			b->v[i]);
+	}
+
+	x4_carry(r->v, t);
+}
+
+F25519X4_TARGET void f25519x4_neg(struct f25519x4 *r,
+				  const struct f25519x4 *a)
+{
+	struct f25519x4 zero;
+
+	f25519x4_load(&zero, 0);
+	f25519x4_sub(r, &zero, a);
+}
+
+F25519X4_TARGET void f25519x4_mul(struct f25519x4 *r,
+				  const struct f25519x4 *a,
+				  const struct f25519x4 *b)
+{
+	/* r_k = sum of a_i b_j over i + j = k (mod 10). Odd limbs of a
+	 * carry an extra factor 2 when multiplied by odd limbs of b, and
+	 * wrapped-around terms (i + j >= 10) a factor 19. All factors fit
+	 * in 32 bits, as vpmuludq needs.
+	 */
+	const __m256i k19 = _mm256_set1_epi64x(19);
+	__m256i a2[10];
+	__m256i b19[10];
+	__m256i t[10];
+	int i;
+	int j;
+
+	for (i = 0; i < 10; i++) {
+		a2[i] = (i & 1) ? _mm256_add_epi64(a->v[i], a->v[i]) : a->v[i];
+		b19[i] = _mm256_mul_epu32(b->v[i], k19);
+		t[i] = _mm256_setzero_si256();
+	}
+
+#pragma GCC unroll 10
+	for (i = 0; i < 10; i++) {
+#pragma GCC unroll 10
+		for (j = 0; j < 10; j++) {
+			const __m256i x = (i & j & 1) ? a2[i] : a->v[i];
+			const __m256i y = (i + j >= 10) ? b19[j] : b->v[j];
+			const int k = (i + j) % 10;
+
+			t[k] = _mm256_add_epi64(t[k], _mm256_mul_epu32(x, y));
+		}
+	}
+
+	x4_carry(r->v, t);
+}
+
+F25519X4_TARGET void f25519x4_sqr(struct f25519x4 *r,
+				  const struct f25519x4 *a)
+{
+	/* As f25519x4_mul(a, a), with each cross product a_i a_j (i < j)
+	 * computed once and doubled: 55 products instead of 100.
+	 */
+	const __m256i k19 = _mm256_set1_epi64x(19);
+	__m256i d[10];
+	__m256i q[10];
+	__m256i a19[10];
+	__m256i t[10];
+	int i;
+	int j;
+
+	for (i = 0; i < 10; i++) {
+		d[i] = _mm256_add_epi64(a->v[i], a->v[i]);
+		q[i] = _mm256_add_epi64(d[i], d[i]);
+		a19[i] = _mm256_mul_epu32(a->v[i], k19);
+		t[i] = _mm256_setzero_si256();
+	}
+
+#pragma GCC unroll 10
+	for (i = 0; i < 10; i++) {
+		const __m256i x = (i & 1) ? d[i] : a->v[i];
+		const __m256i y = (i * 2 >= 10) ? a19[i] : a->v[i];
+		const int k = (i * 2) % 10;
+
+		t[k] = _mm256_add_epi64(t[k], _mm256_mul_epu32(x, y));
+
+#pragma GCC unroll 10
+		for (j = i + 1; j < 10; j++) {
+			const __m256i x2 = (i & j & 1) ? q[i] : d[i];
+			const __m256i y2 = (i + j >= 10) ? a19[j] : a->v[j];
+			const int k2 = (i + j) % 10;
+
+			t[k2] = _mm256_add_epi64(t[k2],
+						 _mm256_mul_epu32(x2, y2));
+		}
+	}
+
+	x4_carry(r->v, t);
+}
+
+#endif
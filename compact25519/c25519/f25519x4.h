@@ -0,0 +1,94 @@
+/* Four-way arithmetic mod p = 2^255-19 for x86 with AVX2
+ *
+ * This file is in the public domain.
+ */
+
+#ifndef F25519X4_H_
+#define F25519X4_H_
+
+#include "f25519.h"
+
+/* Four independent field elements are processed by one instruction
+ * stream: limb i of each element sits in a 64-bit lane of a 256-bit
+ * register, in radix 2^25.5 (ten limbs of alternately 26 and 25 bits).
+ * This is for batch workloads running the same point formulas on
+ * unrelated points, such as batch signing and verification.
+ *
+ * Code using it is compiled for AVX2 by function attributes, so the
+ * rest of the program needn't be. Check f25519x4_available() at run
+ * time before calling anything else; CPUs without AVX2 must use the
+ * one-way functions in f25519.h instead.
+ *
+ * Set F25519_X4 to 0 to leave this out.
+ */
+#ifndef F25519_X4
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define F25519_X4  1
+#else
+#define F25519_X4  0
+#endif
+#endif
+
+#if F25519_X4
+#include <immintrin.h>
+
+#define F25519X4_TARGET  __attribute__((target("avx2")))
+
+/* Four field elements. Limbs are unsigned and not fully carried: the
+ * outputs of everything except f25519x4_add() are below 2^26 (even
+ * limbs) and 2^25 (odd limbs), give or take a few bits of the next
+ * carry. Sums of up to three such elements are still valid inputs to
+ * every operation; anything larger must be reduced by a subtraction
+ * or multiplication first.
+ */
+struct f25519x4 {
+	__m256i  v[10];
+};
+
+/* Does this CPU have AVX2? */
+uint8_t f25519x4_available(void);
+
+/* Lanes 0..3 from/to four 32-byte elements. Gathered elements may be
+ * un-normalized; scattered elements are fully reduced (0 <= x < p).
+ */
+void f25519x4_gather(struct f25519x4 *r,
+		     const uint8_t *a0, const uint8_t *a1,
+		     const uint8_t *a2, const uint8_t *a3);
+void f25519x4_scatter(uint8_t *r0, uint8_t *r1, uint8_t *r2, uint8_t *r3,
+		      const struct f25519x4 *a);
+
+/* An element in the carried limb form of a lane, for constants that
+ * are blended into all lanes many times: split them once, rather than
+ * gathering them from bytes on every use.
+ */
+typedef uint32_t f25519x4_limbs[10];
+
+void f25519x4_split(f25519x4_limbs r, const uint8_t *a);
+
+/* Set every lane to a small constant */
+void f25519x4_load(struct f25519x4 *r, uint32_t c);
+
+/* Lane-wise select: lanes whose mask is all ones are taken from one,
+ * lanes whose mask is zero from zero.
+ */
+void f25519x4_select(struct f25519x4 *r,
+		     const struct f25519x4 *zero, const struct f25519x4 *one,
+		     const __m256i *mask);
+
+/* As f25519x4_select(), with the same element one in every lane */
+void f25519x4_select_limbs(struct f25519x4 *r,
+			   const struct f25519x4 *zero,
+			   const f25519x4_limbs one, const __m256i *mask);
+
+/* Lane-wise arithmetic. Pointers are not required to be distinct. */
+void f25519x4_add(struct f25519x4 *r,
+		  const struct f25519x4 *a, const struct f25519x4 *b);
+void f25519x4_sub(struct f25519x4 *r,
+		  const struct f25519x4 *a, const struct f25519x4 *b);
+void f25519x4_neg(struct f25519x4 *r, const struct f25519x4 *a);
+void f25519x4_mul(struct f25519x4 *r,
+		  const struct f25519x4 *a, const struct f25519x4 *b);
+void f25519x4_sqr(struct f25519x4 *r, const struct f25519x4 *a);
+
+#endif
+#endif
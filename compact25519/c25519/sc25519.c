@@ -0,0 +1,146 @@
+/* Arithmetic modulo the order of the Ed25519 base point
+ *
+ * This file is in the public domain.
+ */
+
+#include "sc25519.h"
+
+#ifndef COMPACT_DISABLE_ED25519
+#include <string.h>
+
+/* L, in 32-bit words */
+static const uint32_t sc25519_order[8] = {
+	0x5cf5d3ed, 0x5812631a, 0xa2f79cd6, 0x14def9de,
+	0x00000000, 0x00000000, 0x00000000, 0x10000000
+};
+
+/* floor(2^512 / L), for Barrett reduction */
+static const uint32_t sc25519_barrett[9] = {
+	0x0a2c131b, 0xed9ce5a3, 0x086329a7, 0x2106215d,
+	0xffffffeb, 0xffffffff, 0xffffffff, 0xffffffff,
+	0x0000000f
+};
+
+static void sc_load(uint32_t *w, const uint8_t *x, int n)
+{
+	int i;
+
+	for (i = 0; i < n; i++)
+		w[i] = ((uint32_t)x[i * 4]) |
+		       (((uint32_t)x[i * 4 + 1]) << 8) |
+		       (((uint32_t)x[i * 4 + 2]) << 16) |
+		       (((uint32_t)x[i * 4 + 3]) << 24);
+}
+
+static void sc_store(uint8_t *x, const uint32_t *w)
+{
+	int i;
+
+	for (i = 0; i < 8; i++) {
+		x[i * 4] = w[i];
+		x[i * 4 + 1] = w[i] >> 8;
+		x[i * 4 + 2] = w[i] >> 16;
+		x[i * 4 + 3] = w[i] >> 24;
+	}
+}
+
+/* Reduce a 512-bit value x, returning 0 <= r < L.
+ *
+ * With q = floor(x * floor(2^512 / L) / 2^512), q is either floor(x / L)
+ * or one less, so x - qL is below 2L and fits in 256 bits. It is
+ * computed mod 2^256, and L is subtracted once more if necessary.
+ */
+static void sc_barrett(uint8_t *r, const uint32_t *x)
+{
+	uint32_t xr[25];
+	uint32_t t[8];
+	uint64_t c;
+	uint32_t borrow;
+	uint32_t mask;
+	int i;
+	int j;
+
+	/* xr = x * floor(2^512 / L) */
+	memset(xr, 0, sizeof(xr));
+	for (i = 0; i < 9; i++) {
+		c = 0;
+		for (j = 0; j < 16; j++) {
+			c += xr[i + j] + (uint64_t)sc25519_barrett[i] * x[j];
+			xr[i + j] = c;
+			c >>= 32;
+		}
+		xr[i + 16] = c;
+	}
+
+	/* t = q * L mod 2^256, where q = xr[16..24] */
+	memset(t, 0, sizeof(t));
+	for (i = 0; i < 8; i++) {
+		c = 0;
+		for (j = 0; j < 8 - i; j++) {
+			c += t[i + j] + (uint64_t)xr[i + 16] * sc25519_order[j];
+			t[i + j] = c;
+			c >>= 32;
+		}
+	}
+
+	/* t = x - t mod 2^256 */
+	c = 1;
+	for (i = 0; i < 8; i++) {
+		c += (uint64_t)x[i] + (uint32_t)~t[i];
+		t[i] = c;
+		c >>= 32;
+	}
+
+	/* xr = t - L. Keep it if that didn't borrow, i.e. if t >= L. */
+	c = 1;
+	for (i = 0; i < 8; i++) {
+		c += (uint64_t)t[i] + (uint32_t)~sc25519_order[i];
+		xr[i] = c;
+		c >>= 32;
+	}
+
+	borrow = 1 - (uint32_t)c;
+	mask = borrow - 1;
+	for (i = 0; i < 8; i++)
+		t[i] = (t[i] & ~mask) | (xr[i] & mask);
+
+	sc_store(r, t);
+}
+
+void sc25519_reduce(uint8_t *r, const uint8_t *x)
+{
+	uint32_t w[16];
+
+	sc_load(w, x, 16);
+	sc_barrett(r, w);
+}
+
+void sc25519_mul_add(uint8_t *r, const uint8_t *a, const uint8_t *b,
+		     const uint8_t *c)
+{
+	uint32_t wa[8];
+	uint32_t wb[8];
+	uint32_t p[16];
+	uint64_t carry;
+	int i;
+	int j;
+
+	sc_load(wa, a, 8);
+	sc_load(wb, b, 8);
+	sc_load(p, c, 8);
+	memset(p + 8, 0, 8 * sizeof(p[0]));
+
+	/* p = a * b + c */
+	for (i = 0; i < 8; i++) {
+		carry = 0;
+		for (j = 0; j < 8; j++) {
+			carry += p[i + j] + (uint64_t)wa[i] * wb[j];
+			p[i + j] = carry;
+			carry >>= 32;
+		}
+		p[i + 8] = carry;
+	}
+
+	sc_barrett(r, p);
+}
+#endif
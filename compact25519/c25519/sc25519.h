@@ -0,0 +1,36 @@
+/* Arithmetic modulo the order of the Ed25519 base point
+ *
+ * This file is in the public domain.
+ */
+
+#ifndef SC25519_H_
+#define SC25519_H_
+
+#ifndef COMPACT_DISABLE_ED25519
+#include <stdint.h>
+
+/* Scalars are integers modulo the group order
+ *
+ *     L = 2^252 + 27742317777372353535851937790883648493
+ *
+ * stored as 32-byte little-endian strings. Unlike fprime, which walks
+ * the modulus one bit at a time, these routines work on 32-bit words
+ * and reduce with a single Barrett step. They are specific to L, and
+ * are constant time.
+ */
+#define SC25519_SIZE  32
+
+/* Reduce a 64-byte string (such as a SHA-512 digest) modulo L. r and x
+ * may overlap.
+ */
+void sc25519_reduce(uint8_t *r, const uint8_t *x);
+
+/* Compute r = a * b + c modulo L. The inputs need not be reduced, but
+ * a * b + c must fit in 512 bits, which holds for any three 32-byte
+ * values with a and b below 2^255. r may alias any of the inputs.
+ */
+void sc25519_mul_add(uint8_t *r, const uint8_t *a, const uint8_t *b,
+		     const uint8_t *c);
+
+#endif
+#endif
@@ -57,6 +57,39 @@ static const uint64_t round_k[80] = {
 	0x5fcb6fab3ad6faecLL, 0x6c44198c4a475817LL,
 };
 
+/* Big-endian words. Where the byte order is known, a word is one load
+ * and a byte swap; 8-bit parts keep to bytes.
+ */
+#if defined(__GNUC__) && !defined(__AVR__) && defined(__BYTE_ORDER__) && \
+    __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+static inline uint64_t load64(const uint8_t *x)
+{
+	uint64_t r;
+
+	memcpy(&r, x, 8);
+	return __builtin_bswap64(r);
+}
+
+static inline void store64(uint8_t *x, uint64_t v)
+{
+	v = __builtin_bswap64(v);
+	memcpy(x, &v, 8);
+}
+#elif defined(__GNUC__) && !defined(__AVR__) && defined(__BYTE_ORDER__) && \
+    __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+static inline uint64_t load64(const uint8_t *x)
+{
+	uint64_t r;
+
+	memcpy(&r, x, 8);
+	return r;
+}
+
+static inline void store64(uint8_t *x, uint64_t v)
+{
+	memcpy(x, &v, 8);
+}
+#else
 static inline uint64_t load64(const uint8_t *x)
 {
 	uint64_t r;
@@ -92,12 +125,14 @@ static inline void store64(uint8_t *x, uint64_t v)
 	v >>= 8;
 	*(x--) = v;
 }
+#endif
 
 static inline uint64_t rot64(uint64_t x, int bits)
 {
 	return (x >> bits) | (x << (64 - bits));
 }
 
+#if SHA512_BACKEND == SHA512_BACKEND_COMPACT
 void sha512_block(struct sha512_state *s, const uint8_t *blk)
 {
 	uint64_t w[16];
@@ -162,6 +197,263 @@ void sha512_block(struct sha512_state *s, const uint8_t *blk)
 	s->h[6] += g;
 	s->h[7] += h;
 }
+#elif SHA512_BACKEND == SHA512_BACKEND_WORD32
+/* A 64-bit word as two 32-bit halves, so that 32-bit parts needn't
+ * spill the double-register values a compiler makes of uint64_t.
+ * Rotations by 32 bits or more are a swap of the halves, for free.
+ */
+struct sha512_w32 {
+	uint32_t  hi;
+	uint32_t  lo;
+};
+
+static inline struct sha512_w32 w32_load(const uint8_t *x)
+{
+	struct sha512_w32 r;
+
+	r.hi = ((uint32_t)x[0] << 24) | ((uint32_t)x[1] << 16) |
+	       ((uint32_t)x[2] << 8) | x[3];
+	r.lo = ((uint32_t)x[4] << 24) | ((uint32_t)x[5] << 16) |
+	       ((uint32_t)x[6] << 8) | x[7];
+	return r;
+}
+
+static inline struct sha512_w32 w32_of(uint64_t x)
+{
+	struct sha512_w32 r;
+
+	r.hi = x >> 32;
+	r.lo = x;
+	return r;
+}
+
+static inline struct sha512_w32 w32_add(struct sha512_w32 a,
+					struct sha512_w32 b)
+{
+	struct sha512_w32 r;
+
+	r.lo = a.lo + b.lo;
+	r.hi = a.hi + b.hi + (r.lo < a.lo);
+	return r;
+}
+
+static inline struct sha512_w32 w32_xor(struct sha512_w32 a,
+					struct sha512_w32 b)
+{
+	a.hi ^= b.hi;
+	a.lo ^= b.lo;
+	return a;
+}
+
+/* Rotate right by 0 < bits < 32 */
+static inline struct sha512_w32 w32_rot(struct sha512_w32 x, int bits)
+{
+	struct sha512_w32 r;
+
+	r.hi = (x.hi >> bits) | (x.lo << (32 - bits));
+	r.lo = (x.lo >> bits) | (x.hi << (32 - bits));
+	return r;
+}
+
+/* Rotate right by 32 < bits < 64 */
+static inline struct sha512_w32 w32_rot_hi(struct sha512_w32 x, int bits)
+{
+	struct sha512_w32 r;
+
+	r.hi = (x.lo >> (bits - 32)) | (x.hi << (64 - bits));
+	r.lo = (x.hi >> (bits - 32)) | (x.lo << (64 - bits));
+	return r;
+}
+
+/* Shift right by 0 < bits < 32 */
+static inline struct sha512_w32 w32_shr(struct sha512_w32 x, int bits)
+{
+	struct sha512_w32 r;
+
+	r.hi = x.hi >> bits;
+	r.lo = (x.lo >> bits) | (x.hi << (32 - bits));
+	return r;
+}
+
+static inline struct sha512_w32 w32_ch(struct sha512_w32 e,
+				       struct sha512_w32 f,
+				       struct sha512_w32 g)
+{
+	struct sha512_w32 r;
+
+	r.hi = g.hi ^ (e.hi & (f.hi ^ g.hi));
+	r.lo = g.lo ^ (e.lo & (f.lo ^ g.lo));
+	return r;
+}
+
+static inline struct sha512_w32 w32_maj(struct sha512_w32 a,
+					struct sha512_w32 b,
+					struct sha512_w32 c)
+{
+	struct sha512_w32 r;
+
+	r.hi = (a.hi & b.hi) | (c.hi & (a.hi | b.hi));
+	r.lo = (a.lo & b.lo) | (c.lo & (a.lo | b.lo));
+	return r;
+}
+
+/* One round on variables renamed by the caller, rather than moved */
+#define SHA512_W32_ROUND(a, b, c, d, e, f, g, h, j)			\
+	do {								\
+		const struct sha512_w32 t1 = w32_add(w32_add(		\
+			w32_add(h, w32_xor(w32_xor(w32_rot(e, 14),	\
+				w32_rot(e, 18)), w32_rot_hi(e, 41))),	\
+			w32_add(w32_ch(e, f, g), w32_of(round_k[i + (j)]))), \
+			w[(i + (j)) & 15]);				\
+		const struct sha512_w32 t2 = w32_add(			\
+			w32_xor(w32_xor(w32_rot(a, 28),			\
+				w32_rot_hi(a, 34)), w32_rot_hi(a, 39)),	\
+			w32_maj(a, b, c));				\
+		d = w32_add(d, t1);					\
+		h = w32_add(t1, t2);					\
+	} while (0)
+
+/* w[j] becomes w[j + 16] */
+#define SHA512_W32_SCHEDULE(j)						\
+	do {								\
+		const struct sha512_w32 w15 = w[((j) + 1) & 15];	\
+		const struct sha512_w32 w2 = w[((j) + 14) & 15];	\
+		w[(j) & 15] = w32_add(w32_add(w[(j) & 15],		\
+			w32_xor(w32_xor(w32_rot(w15, 1), w32_rot(w15, 8)), \
+				w32_shr(w15, 7))),			\
+			w32_add(w[((j) + 9) & 15],			\
+			w32_xor(w32_xor(w32_rot(w2, 19),		\
+				w32_rot_hi(w2, 61)), w32_shr(w2, 6)))); \
+	} while (0)
+
+void sha512_block(struct sha512_state *s, const uint8_t *blk)
+{
+	struct sha512_w32 w[16];
+	struct sha512_w32 a, b, c, d, e, f, g, h;
+	int i;
+
+	for (i = 0; i < 16; i++)
+		w[i] = w32_load(blk + i * 8);
+
+	a = w32_of(s->h[0]);
+	b = w32_of(s->h[1]);
+	c = w32_of(s->h[2]);
+	d = w32_of(s->h[3]);
+	e = w32_of(s->h[4]);
+	f = w32_of(s->h[5]);
+	g = w32_of(s->h[6]);
+	h = w32_of(s->h[7]);
+
+	for (i = 0; i < 80; i += 8) {
+		int j;
+
+		if (i >= 16)
+			for (j = i; j < i + 8; j++)
+				SHA512_W32_SCHEDULE(j);
+
+		SHA512_W32_ROUND(a, b, c, d, e, f, g, h, 0);
+		SHA512_W32_ROUND(h, a, b, c, d, e, f, g, 1);
+		SHA512_W32_ROUND(g, h, a, b, c, d, e, f, 2);
+		SHA512_W32_ROUND(f, g, h, a, b, c, d, e, 3);
+		SHA512_W32_ROUND(e, f, g, h, a, b, c, d, 4);
+		SHA512_W32_ROUND(d, e, f, g, h, a, b, c, 5);
+		SHA512_W32_ROUND(c, d, e, f, g, h, a, b, 6);
+		SHA512_W32_ROUND(b, c, d, e, f, g, h, a, 7);
+	}
+
+	s->h[0] += ((uint64_t)a.hi << 32) | a.lo;
+	s->h[1] += ((uint64_t)b.hi << 32) | b.lo;
+	s->h[2] += ((uint64_t)c.hi << 32) | c.lo;
+	s->h[3] += ((uint64_t)d.hi << 32) | d.lo;
+	s->h[4] += ((uint64_t)e.hi << 32) | e.lo;
+	s->h[5] += ((uint64_t)f.hi << 32) | f.lo;
+	s->h[6] += ((uint64_t)g.hi << 32) | g.lo;
+	s->h[7] += ((uint64_t)h.hi << 32) | h.lo;
+}
+#else
+/* One round on variables renamed by the caller, rather than moved */
+#define SHA512_ROUND(a, b, c, d, e, f, g, h, j)				\
+	do {								\
+		const uint64_t t1 = h +					\
+			(rot64(e, 14) ^ rot64(e, 18) ^ rot64(e, 41)) +	\
+			(g ^ (e & (f ^ g))) + round_k[i + (j)] + w[j];	\
+		const uint64_t t2 =					\
+			(rot64(a, 28) ^ rot64(a, 34) ^ rot64(a, 39)) +	\
+			((a & b) | (c & (a | b)));			\
+		d += t1;						\
+		h = t1 + t2;						\
+	} while (0)
+
+/* w[j] becomes w[j + 16], in place: indices wrap mod 16 */
+#define SHA512_SCHEDULE(j)						\
+	w[j] += (rot64(w[((j) + 14) & 15], 19) ^			\
+		 rot64(w[((j) + 14) & 15], 61) ^			\
+		 (w[((j) + 14) & 15] >> 6)) + w[((j) + 9) & 15] +	\
+		(rot64(w[((j) + 1) & 15], 1) ^				\
+		 rot64(w[((j) + 1) & 15], 8) ^				\
+		 (w[((j) + 1) & 15] >> 7))
+
+void sha512_block(struct sha512_state *s, const uint8_t *blk)
+{
+	uint64_t w[16];
+	uint64_t a, b, c, d, e, f, g, h;
+	int i;
+
+	for (i = 0; i < 16; i++)
+		w[i] = load64(blk + i * 8);
+
+	a = s->h[0];
+	b = s->h[1];
+	c = s->h[2];
+	d = s->h[3];
+	e = s->h[4];
+	f = s->h[5];
+	g = s->h[6];
+	h = s->h[7];
+
+	/* Sixteen rounds per iteration, so that every index into w is a
+	 * constant and the schedule lives in registers
+	 */
+	for (i = 0; i < 80; i += 16) {
+		if (i) {
+			SHA512_SCHEDULE(0);  SHA512_SCHEDULE(1);
+			SHA512_SCHEDULE(2);  SHA512_SCHEDULE(3);
+			SHA512_SCHEDULE(4);  SHA512_SCHEDULE(5);
+			SHA512_SCHEDULE(6);  SHA512_SCHEDULE(7);
+			SHA512_SCHEDULE(8);  SHA512_SCHEDULE(9);
+			SHA512_SCHEDULE(10); SHA512_SCHEDULE(11);
+			SHA512_SCHEDULE(12); SHA512_SCHEDULE(13);
+			SHA512_SCHEDULE(14); SHA512_SCHEDULE(15);
+		}
+
+		SHA512_ROUND(a, b, c, d, e, f, g, h, 0);
+		SHA512_ROUND(h, a, b, c, d, e, f, g, 1);
+		SHA512_ROUND(g, h, a, b, c, d, e, f, 2);
+		SHA512_ROUND(f, g, h, a, b, c, d, e, 3);
+		SHA512_ROUND(e, f, g, h, a, b, c, d, 4);
+		SHA512_ROUND(d, e, f, g, h, a, b, c, 5);
+		SHA512_ROUND(c, d, e, f, g, h, a, b, 6);
+		SHA512_ROUND(b, c, d, e, f, g, h, a, 7);
+		SHA512_ROUND(a, b, c, d, e, f, g, h, 8);
+		SHA512_ROUND(h, a, b, c, d, e, f, g, 9);
+		SHA512_ROUND(g, h, a, b, c, d, e, f, 10);
+		SHA512_ROUND(f, g, h, a, b, c, d, e, 11);
+		SHA512_ROUND(e, f, g, h, a, b, c, d, 12);
+		SHA512_ROUND(d, e, f, g, h, a, b, c, 13);
+		SHA512_ROUND(c, d, e, f, g, h, a, b, 14);
+		SHA512_ROUND(b, c, d, e, f, g, h, a, 15);
+	}
+
+	s->h[0] += a;
+	s->h[1] += b;
+	s->h[2] += c;
+	s->h[3] += d;
+	s->h[4] += e;
+	s->h[5] += f;
+	s->h[6] += g;
+	s->h[7] += h;
+}
+#endif
 
 void sha512_final(struct sha512_state *s, const uint8_t *blk,
 		  size_t total_size)
@@ -227,4 +519,236 @@ void sha512_get(const struct sha512_state *s, uint8_t *hash,
 		memcpy(hash, tmp, len);
 	}
 }
+
+#if SHA512_X4
+#include <immintrin.h>
+
+#define SHA512X4_TARGET  __attribute__((target("avx2")))
+
+uint8_t sha512x4_available(void)
+{
+#ifdef __AVX2__
+	return 1;
+#else
+	return __builtin_cpu_supports("avx2") ? 1 : 0;
+#endif
+}
+
+/* AVX2 has no 64-bit rotation: two shifts and an OR */
+#define X4_ROT(x, n) \
+	_mm256_or_si256(_mm256_srli_epi64(x, n), _mm256_slli_epi64(x, 64 - (n)))
+#define X4_ADD(a, b)  _mm256_add_epi64(a, b)
+#define X4_XOR(a, b)  _mm256_xor_si256(a, b)
+
+#define SHA512X4_ROUND(a, b, c, d, e, f, g, h, j)			\
+	do {								\
+		const __m256i t1 = X4_ADD(X4_ADD(h,			\
+			X4_XOR(X4_XOR(X4_ROT(e, 14), X4_ROT(e, 18)),	\
+			       X4_ROT(e, 41))),				\
+			X4_ADD(X4_XOR(g, _mm256_and_si256(e, X4_XOR(f, g))), \
+			       X4_ADD(_mm256_set1_epi64x(		\
+					(long long)round_k[i + (j)]),	\
+				      w[j])));				\
+		const __m256i t2 = X4_ADD(				\
+			X4_XOR(X4_XOR(X4_ROT(a, 28), X4_ROT(a, 34)),	\
+			       X4_ROT(a, 39)),				\
+			_mm256_or_si256(_mm256_and_si256(a, b),		\
+				_mm256_and_si256(c, _mm256_or_si256(a, b)))); \
+		d = X4_ADD(d, t1);					\
+		h = X4_ADD(t1, t2);					\
+	} while (0)
+
+#define SHA512X4_SCHEDULE(j)						\
+	do {								\
+		const __m256i w2 = w[((j) + 14) & 15];			\
+		const __m256i w15 = w[((j) + 1) & 15];			\
+		w[j] = X4_ADD(X4_ADD(w[j], w[((j) + 9) & 15]), X4_ADD(	\
+			X4_XOR(X4_XOR(X4_ROT(w2, 19), X4_ROT(w2, 61)),	\
+			       _mm256_srli_epi64(w2, 6)),		\
+			X4_XOR(X4_XOR(X4_ROT(w15, 1), X4_ROT(w15, 8)),	\
+			       _mm256_srli_epi64(w15, 7))));		\
+	} while (0)
+
+/* One block into each lane. Lane l of state word i is h[i], of message
+ * word j is w[j].
+ */
+static SHA512X4_TARGET void x4_block(__m256i *state, __m256i *w)
+{
+	__m256i a = state[0];
+	__m256i b = state[1];
+	__m256i c = state[2];
+	__m256i d = state[3];
+	__m256i e = state[4];
+	__m256i f = state[5];
+	__m256i g = state[6];
+	__m256i h = state[7];
+	int i;
+
+	for (i = 0; i < 80; i += 16) {
+		if (i) {
+			SHA512X4_SCHEDULE(0);  SHA512X4_SCHEDULE(1);
+			SHA512X4_SCHEDULE(2);  SHA512X4_SCHEDULE(3);
+			SHA512X4_SCHEDULE(4);  SHA512X4_SCHEDULE(5);
+			SHA512X4_SCHEDULE(6);  SHA512X4_SCHEDULE(7);
+			SHA512X4_SCHEDULE(8);  SHA512X4_SCHEDULE(9);
+			SHA512X4_SCHEDULE(10); SHA512X4_SCHEDULE(11);
+			SHA512X4_SCHEDULE(12); SHA512X4_SCHEDULE(13);
+			SHA512X4_SCHEDULE(14); SHA512X4_SCHEDULE(15);
+		}
+
+		SHA512X4_ROUND(a, b, c, d, e, f, g, h, 0);
+		SHA512X4_ROUND(h, a, b, c, d, e, f, g, 1);
+		SHA512X4_ROUND(g, h, a, b, c, d, e, f, 2);
+		SHA512X4_ROUND(f, g, h, a, b, c, d, e, 3);
+		SHA512X4_ROUND(e, f, g, h, a, b, c, d, 4);
+		SHA512X4_ROUND(d, e, f, g, h, a, b, c, 5);
+		SHA512X4_ROUND(c, d, e, f, g, h, a, b, 6);
+		SHA512X4_ROUND(b, c, d, e, f, g, h, a, 7);
+		SHA512X4_ROUND(a, b, c, d, e, f, g, h, 8);
+		SHA512X4_ROUND(h, a, b, c, d, e, f, g, 9);
+		SHA512X4_ROUND(g, h, a, b, c, d, e, f, 10);
+		SHA512X4_ROUND(f, g, h, a, b, c, d, e, 11);
+		SHA512X4_ROUND(e, f, g, h, a, b, c, d, 12);
+		SHA512X4_ROUND(d, e, f, g, h, a, b, c, 13);
+		SHA512X4_ROUND(c, d, e, f, g, h, a, b, 14);
+		SHA512X4_ROUND(b, c, d, e, f, g, h, a, 15);
+	}
+
+	state[0] = X4_ADD(state[0], a);
+	state[1] = X4_ADD(state[1], b);
+	state[2] = X4_ADD(state[2], c);
+	state[3] = X4_ADD(state[3], d);
+	state[4] = X4_ADD(state[4], e);
+	state[5] = X4_ADD(state[5], f);
+	state[6] = X4_ADD(state[6], g);
+	state[7] = X4_ADD(state[7], h);
+}
+
+/* w[j] = word j of blk[0..3], four words of each block at a time:
+ * byte-swap, then transpose 4x4
+ */
+static SHA512X4_TARGET void x4_load_block(__m256i *w,
+					  const uint8_t *const *blk)
+{
+	const __m256i bswap = _mm256_setr_epi8(
+		7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8,
+		7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8);
+	int i;
+
+	for (i = 0; i < 16; i += 4) {
+		const __m256i r0 = _mm256_shuffle_epi8(_mm256_loadu_si256(
+			(const __m256i *)(blk[0] + i * 8)), bswap);
+		const __m256i r1 = _mm256_shuffle_epi8(_mm256_loadu_si256(
+			(const __m256i *)(blk[1] + i * 8)), bswap);
+		const __m256i r2 = _mm256_shuffle_epi8(_mm256_loadu_si256(
+			(const __m256i *)(blk[2] + i * 8)), bswap);
+		const __m256i r3 = _mm256_shuffle_epi8(_mm256_loadu_si256(
+			(const __m256i *)(blk[3] + i * 8)), bswap);
+		const __m256i t0 = _mm256_unpacklo_epi64(r0, r1);
+		const __m256i t1 = _mm256_unpackhi_epi64(r0, r1);
+		const __m256i t2 = _mm256_unpacklo_epi64(r2, r3);
+		const __m256i t3 = _mm256_unpackhi_epi64(r2, r3);
+
+		w[i] = _mm256_permute2x128_si256(t0, t2, 0x20);
+		w[i + 1] = _mm256_permute2x128_si256(t1, t3, 0x20);
+		w[i + 2] = _mm256_permute2x128_si256(t0, t2, 0x31);
+		w[i + 3] = _mm256_permute2x128_si256(t1, t3, 0x31);
+	}
+}
+
+/* Block n of the padded stream head || body, as sha512_final() pads
+ * it. Returns a pointer into body when the block lies wholly inside it,
+ * or else builds the block in tmp.
+ */
+static const uint8_t *x4_stream_block(uint8_t *tmp,
+				      const uint8_t *head,
+				      unsigned int head_size,
+				      const uint8_t *body, size_t body_size,
+				      size_t n)
+{
+	const size_t total = head_size + body_size;
+	const size_t pos = n * SHA512_BLOCK_SIZE;
+	size_t i = 0;
+
+	if (pos >= head_size && pos + SHA512_BLOCK_SIZE <= total)
+		return body + (pos - head_size);
+
+	memset(tmp, 0, SHA512_BLOCK_SIZE);
+
+	/* Only the first block has any of the head */
+	if (!n) {
+		memcpy(tmp, head, head_size);
+		i = head_size;
+	}
+
+	if (pos + i < total) {
+		size_t c = total - (pos + i);
+
+		if (c > SHA512_BLOCK_SIZE - i)
+			c = SHA512_BLOCK_SIZE - i;
+
+		memcpy(tmp + i, body + (pos + i - head_size), c);
+		i += c;
+	}
+
+	if (pos + i == total && i < SHA512_BLOCK_SIZE)
+		tmp[i] = 0x80;
+
+	/* The last block ends with the size in bits. As in
+	 * sha512_final(), we assume it fits in 61 bits.
+	 */
+	if (n == (total + 16) / SHA512_BLOCK_SIZE)
+		store64(tmp + SHA512_BLOCK_SIZE - 8, total << 3);
+
+	return tmp;
+}
+
+SHA512X4_TARGET
+void sha512x4(uint8_t *const *hash,
+	      const uint8_t *const *head, unsigned int head_size,
+	      const uint8_t *const *body, const size_t *body_size)
+{
+	uint8_t tmp[4][SHA512_BLOCK_SIZE];
+	__m256i state[8];
+	__m256i w[16];
+	size_t blocks[4];
+	size_t max_blocks = 0;
+	size_t n;
+	int i;
+	int l;
+
+	for (l = 0; l < 4; l++) {
+		blocks[l] = (head_size + body_size[l] + 16) /
+			SHA512_BLOCK_SIZE + 1;
+		if (blocks[l] > max_blocks)
+			max_blocks = blocks[l];
+	}
+
+	for (i = 0; i < 8; i++)
+		state[i] = _mm256_set1_epi64x(
+			(long long)sha512_initial_state.h[i]);
+
+	for (n = 0; n < max_blocks; n++) {
+		const uint8_t *blk[4];
+
+		/* Lanes already done hash whatever; they were read out */
+		for (l = 0; l < 4; l++)
+			blk[l] = x4_stream_block(tmp[l], head[l], head_size,
+						 body[l], body_size[l], n);
+
+		x4_load_block(w, blk);
+
+		x4_block(state, w);
+
+		for (i = 0; i < 8; i++) {
+			uint64_t lanes[4];
+
+			_mm256_storeu_si256((__m256i *)lanes, state[i]);
+			for (l = 0; l < 4; l++)
+				if (n + 1 == blocks[l])
+					store64(hash[l] + i * 8, lanes[l]);
+		}
+	}
+}
+#endif
 #endif
@@ -50,5 +50,56 @@ void sha512_final(struct sha512_state *s, const uint8_t *blk,
 void sha512_get(const struct sha512_state *s, uint8_t *hash,
 		unsigned int offset, unsigned int len);
 
+/* Compression function behind sha512_block(). All of them compute the
+ * same thing; pick by the word size of the target.
+ *
+ *     SHA512_BACKEND_COMPACT  one round per loop iteration, smallest
+ *                             code, for 8-bit parts
+ *     SHA512_BACKEND_WORD32   words held as 32-bit halves, eight rounds
+ *                             per iteration, for 32-bit parts without
+ *                             64-bit registers (Cortex-M, Xtensa, ...)
+ *     SHA512_BACKEND_WORD64   fully unrolled rounds on 64-bit words,
+ *                             for 64-bit hosts
+ */
+#define SHA512_BACKEND_COMPACT  0
+#define SHA512_BACKEND_WORD32   1
+#define SHA512_BACKEND_WORD64   2
+
+#ifndef SHA512_BACKEND
+#if defined(__AVR__)
+#define SHA512_BACKEND  SHA512_BACKEND_COMPACT
+#elif defined(__SIZEOF_INT128__)
+#define SHA512_BACKEND  SHA512_BACKEND_WORD64
+#else
+#define SHA512_BACKEND  SHA512_BACKEND_WORD32
+#endif
+#endif
+
+/* Four-way hashing for x86 with AVX2: one message per 64-bit lane, for
+ * batch signing. Code using it is compiled for AVX2 by function
+ * attributes; check sha512x4_available() at run time before calling
+ * sha512x4(). Set SHA512_X4 to 0 to leave it out.
+ */
+#ifndef SHA512_X4
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define SHA512_X4  1
+#else
+#define SHA512_X4  0
+#endif
+#endif
+
+#if SHA512_X4
+/* Does this CPU have AVX2? */
+uint8_t sha512x4_available(void);
+
+/* hash[i] = SHA512(head[i] || body[i]) for i < 4. All heads are
+ * head_size bytes long, at most one block; bodies may differ in size.
+ * Lanes finish with the longest message.
+ */
+void sha512x4(uint8_t *const *hash,
+	      const uint8_t *const *head, unsigned int head_size,
+	      const uint8_t *const *body, const size_t *body_size);
+#endif
+
 #endif
 #endif
@@ -1,30 +1,45 @@
 #include <stdint.h>
 #include <stddef.h>
 #include <string.h>
-#include <stdlib.h>
-#include <stdbool.h>
+
+#include "cryptography.h"
+#include "microsui_config.h"
+#include "bech32_table.h"
+#include "monocypher/monocypher.h"
 
 static const char ALPHABET[] = "qpzry9x8gf2tvdw0s3jn54khce6mua7l";
 
+// Value of each alphabet character, in either case; -1 for anything else
 static const int8_t ALPHABET_MAP[128] = {
-    ['q'] = 0,  ['p'] = 1,  ['z'] = 2,  ['r'] = 3,
-    ['y'] = 4,  ['9'] = 5,  ['x'] = 6,  ['8'] = 7,
-    ['g'] = 8,  ['f'] = 9,  ['2'] = 10, ['t'] = 11,
-    ['v'] = 12, ['d'] = 13, ['w'] = 14, ['0'] = 15,
-    ['s'] = 16, ['3'] = 17, ['j'] = 18, ['n'] = 19,
-    ['5'] = 20, ['4'] = 21, ['k'] = 22, ['h'] = 23,
-    ['c'] = 24, ['e'] = 25, ['6'] = 26, ['m'] = 27,
-    ['u'] = 28, ['a'] = 29, ['7'] = 30, ['l'] = 31
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    15, -1, 10, 17, 21, 20, 26, 30,  7,  5, -1, -1, -1, -1, -1, -1,
+    -1, 29, -1, 24, 13, 25,  9,  8, 23, -1, 18, 22, 31, 27, 19, -1,
+     1,  0,  3, 16, 11, 28, 12, 14,  6,  4,  2, -1, -1, -1, -1, -1,
+    -1, 29, -1, 24, 13, 25,  9,  8, 23, -1, 18, 22, 31, 27, 19, -1,
+     1,  0,  3, 16, 11, 28, 12, 14,  6,  4,  2, -1, -1, -1, -1, -1
 };
 
-static const size_t PK_BECH32_LEN = 70; // Length of Sui private key in Bech32 format
-
-#define TOLOWER(c)  ( ((unsigned char)(c) >= 'A' && (unsigned char)(c) <= 'Z') \
-                          ? ((unsigned char)(c) + ('a' - 'A'))                   \
-                          : (unsigned char)(c) )
+// Layout of a Sui private key in Bech32 format: "suiprivkey", the separator
+// '1', the scheme flag and the 32-byte key as 5-bit symbols, and the checksum
+static const char PK_PREFIX[] = "suiprivkey1";
+#define PK_PREFIX_LEN   11
+#define PK_DATA_LEN     53
+#define PK_CHECKSUM_LEN 6
+
+// Folds one 5-bit symbol v, or two symbols packed in 10 bits, into the
+// checksum state c
+#if MICROSUI_BECH32_TABLE
+static uint32_t bech32_fold1(uint32_t c, uint32_t v) {
+    return (((c & 0x1ffffff) << 5) ^ v) ^ bech32_polymod_table[c >> 25];
+}
 
-static uint32_t bech32_polymod(const uint8_t *values, size_t values_len) {
-    uint32_t c = 1;
+static uint32_t bech32_fold2(uint32_t c, uint32_t v) {
+    return (((c & 0xfffff) << 10) ^ v) ^ bech32_polymod_table[c >> 20];
+}
+#else
+static uint32_t bech32_fold1(uint32_t c, uint32_t v) {
     static const uint32_t GEN[5] = {
         0x3b6a57b2UL,
         0x26508e6dUL,
@@ -32,166 +47,153 @@ static uint32_t bech32_polymod(const uint8_t *values, size_t values_len) {
         0x3d4233ddUL,
         0x2a1462b3UL
     };
-    for (size_t i = 0; i < values_len; i++) {
-        uint8_t v = values[i];
-        uint8_t c0 = c >> 25;
-        c = ((c & 0x1ffffff) << 5) ^ v;
-        for (int j = 0; j < 5; j++) {
-            if ((c0 >> j) & 1) {
-                c ^= GEN[j];
-            }
+    uint8_t c0 = c >> 25;
+    c = ((c & 0x1ffffff) << 5) ^ v;
+    for (int j = 0; j < 5; j++) {
+        if ((c0 >> j) & 1) {
+            c ^= GEN[j];
         }
     }
     return c;
 }
 
-static bool convert_bits(uint8_t *out, size_t *out_len, const uint8_t *in, size_t in_len, int from_bits, int to_bits, bool pad) {
-    uint32_t acc = 0;
-    int bits = 0;
-    size_t out_index = 0;
-    uint32_t maxv = (1U << to_bits) - 1;
-    uint32_t max_acc = (1U << (from_bits + to_bits - 1)) - 1;
-    for (size_t i = 0; i < in_len; i++) {
-        acc = ((acc << from_bits) | in[i]) & max_acc;
-        bits += from_bits;
-        while (bits >= to_bits) {
-            bits -= to_bits;
-            if (out) {
-                out[out_index] = (acc >> bits) & maxv;
-            }
-            out_index++;
-        }
-    }
-    if (pad && bits > 0) {
-        if (out) {
-            out[out_index] = (acc << (to_bits - bits)) & maxv;
-        }
-        out_index++;
-    }
-    *out_len = out_index;
-    return true;
+static uint32_t bech32_fold2(uint32_t c, uint32_t v) {
+    return bech32_fold1(bech32_fold1(c, v >> 5), v & 0x1f);
 }
-
-static void expand_hrp(const char *hrp, uint8_t *hrp_expanded, size_t *hrp_exp_len) {
-    size_t hrp_len = strlen(hrp);
-    for (size_t i = 0; i < hrp_len; i++) {
-        hrp_expanded[i] = hrp[i] >> 5;
+#endif
+
+// Running checksum, fed one symbol at a time. Every other symbol is held
+// back so that symbols are folded in pairs.
+typedef struct {
+    uint32_t state;
+    uint32_t held; // held symbol | 0x20, or 0
+} bech32_sum_t;
+
+static void bech32_sum_push(bech32_sum_t* sum, uint32_t v) {
+    if (sum->held) {
+        sum->state = bech32_fold2(sum->state, ((sum->held & 0x1f) << 5) | v);
+        sum->held = 0;
+    } else {
+        sum->held = v | 0x20;
     }
-    hrp_expanded[hrp_len] = 0;
-    for (size_t i = 0; i < hrp_len; i++) {
-        hrp_expanded[hrp_len + 1 + i] = hrp[i] & 0x1F;
-    }
-    *hrp_exp_len = hrp_len * 2 + 1;
 }
 
-static void bech32_create_checksum(const char *hrp, const uint8_t *data, size_t data_len, uint8_t *checksum) {
-    size_t hrp_exp_len = 0;
-    uint8_t *values = malloc((strlen(hrp) * 2 + 1 + data_len + 6) * sizeof(uint8_t));
-    expand_hrp(hrp, values, &hrp_exp_len);
-    memcpy(values + hrp_exp_len, data, data_len);
-
-    for (int i = 0; i < 6; i++) {
-        values[hrp_exp_len + data_len + i] = 0;
-    }
-    uint32_t mod = bech32_polymod(values, hrp_exp_len + data_len + 6) ^ 1;
-    free(values);
-
-    for (int i = 0; i < 6; i++) {
-        checksum[i] = (mod >> (5 * (5 - i))) & 0x1F;
+static uint32_t bech32_sum_final(bech32_sum_t* sum) {
+    if (sum->held) {
+        sum->state = bech32_fold1(sum->state, sum->held & 0x1f);
+        sum->held = 0;
     }
+    return sum->state;
 }
 
 int microsui_decode_sui_privkey(const char *privkey_bech, uint8_t privkey_bytes_output[32]) {
-    size_t len = strlen(privkey_bech);
-    if (len != PK_BECH32_LEN) return -1;
-
-    bool hasLower = false, hasUpper = false;
-    for (size_t i = 0; i < len; i++) {
-        char c = privkey_bech[i];
-        if (c >= 'a' && c <= 'z') hasLower = true;
-        if (c >= 'A' && c <= 'Z') hasUpper = true;
-    }
-    if (hasLower && hasUpper) return -1;
-
-    char str[PK_BECH32_LEN + 1];
-    for (size_t i = 0; i < len; i++) {
-        str[i] = TOLOWER(privkey_bech[i]);
+    bech32_sum_t sum = { BECH32_SUIPRIVKEY_HRP_STATE, 0 };
+    uint8_t ext_secret[33]; // scheme flag || private key
+    uint32_t acc = 0;
+    int bits = 0;
+    size_t out_index = 0;
+    unsigned int cases = 0; // 1: lowercase seen, 2: uppercase seen
+    size_t i;
+    int ret = -1;
+
+    // 1. Human-readable part and separator, in either case
+    for (i = 0; i < PK_PREFIX_LEN; i++) {
+        unsigned char c = (unsigned char)privkey_bech[i];
+        if (c >= 'A' && c <= 'Z') {
+            c += 'a' - 'A';
+            cases |= 2;
+        } else if (c >= 'a' && c <= 'z') {
+            cases |= 1;
+        }
+        if (c != (unsigned char)PK_PREFIX[i]) return -1;
     }
-    str[len] = '\0';
 
-    char *pos = strrchr(str, '1');
-    if (!pos) return -1;
-    size_t sep = pos - str;
-    if (sep < 1 || sep + 7 > len) return -1;
-
-    if (strncmp(str, "suiprivkey", 10) != 0) return -1;
-
-    size_t data_len = len - sep - 1;
-    uint8_t data5[PK_BECH32_LEN + 1];
-    for (size_t i = 0; i < data_len; i++) {
-        char c = str[sep + 1 + i];
-        if (c < 0 || c >= 127 || ALPHABET_MAP[(int)c] == -1) return -1;
-        data5[i] = (uint8_t)ALPHABET_MAP[(int)c];
+    // 2. Data and checksum in one pass: each character is looked up once,
+    //    folded into the checksum and, for data, packed into bytes. A NUL
+    //    is not in the alphabet, so short strings stop here.
+    for (; i < PK_PREFIX_LEN + PK_DATA_LEN + PK_CHECKSUM_LEN; i++) {
+        unsigned char c = (unsigned char)privkey_bech[i];
+        int8_t v = (c < 128) ? ALPHABET_MAP[c] : -1;
+        if (v < 0) goto done;
+        cases |= (c >= 'a') ? 1 : (c >= 'A') ? 2 : 0;
+        bech32_sum_push(&sum, (uint32_t)v);
+        if (i < PK_PREFIX_LEN + PK_DATA_LEN) {
+            acc = ((acc << 5) | (uint32_t)v) & 0xfff;
+            bits += 5;
+            if (bits >= 8) {
+                bits -= 8;
+                ext_secret[out_index++] = (uint8_t)(acc >> bits);
+            }
+        }
     }
 
-    if (data_len < 6) return -1;
-    size_t words_len = data_len - 6;
-    uint8_t words[PK_BECH32_LEN + 1];
-    memcpy(words, data5, words_len);
-
-    const char *hrp = str;
-    size_t hrp_len = sep;
-    uint8_t hrp_expanded[PK_BECH32_LEN + 1];
-    size_t hrp_exp_len = 0;
-    for (size_t i = 0; i < hrp_len; i++) hrp_expanded[hrp_exp_len++] = (uint8_t)(hrp[i] >> 5);
-    hrp_expanded[hrp_exp_len++] = 0;
-    for (size_t i = 0; i < hrp_len; i++) hrp_expanded[hrp_exp_len++] = (uint8_t)(hrp[i] & 0x1F);
-
-    uint8_t ext_secret[35];
-    size_t ext_len = 0;
-    if (!convert_bits(ext_secret, &ext_len, words, words_len, 5, 8, false)) return -1;
-    if (ext_len != 33) return -1;
+    // 3. Whole string in one case, zero padding bit, valid checksum
+    if (privkey_bech[i] != '\0' || cases == 3) goto done;
+    if ((acc & ((1U << bits) - 1)) != 0) goto done;
+    if (bech32_sum_final(&sum) != 1) goto done;
 
     memcpy(privkey_bytes_output, ext_secret + 1, 32);
-    return 0;
+    ret = 0;
+done:
+    crypto_wipe(ext_secret, sizeof(ext_secret));
+    crypto_wipe(&acc, sizeof(acc));
+    return ret;
 }
 
 int microsui_encode_sui_privkey(const uint8_t *privkey_bytes, char *privkey_bech_output) {
-    const char *hrp = "suiprivkey";
-    const uint8_t scheme_flag = 0x00;
-    const size_t output_len = PK_BECH32_LEN + 1;
-
-    uint8_t data[33];
-    data[0] = scheme_flag;
-    memcpy(data + 1, privkey_bytes, 32);
-
-    size_t data5_len = 0;
-    uint8_t data5[(33 * 8 + 4) / 5 + 1];
-    if (!convert_bits(data5, &data5_len, data, 33, 8, 5, true)) {
-        return -1;
-    }
-
-    uint8_t checksum[6];
-    bech32_create_checksum(hrp, data5, data5_len, checksum);
+    bech32_sum_t sum = { BECH32_SUIPRIVKEY_HRP_STATE, 0 };
+    char *out = privkey_bech_output + PK_PREFIX_LEN;
+    uint32_t acc = 0;
+    uint32_t v, mod;
+    int bits = 0;
 
-    size_t hrp_len = strlen(hrp);
-    if (hrp_len + 1 + data5_len + 6 + 1 > output_len) {
-        return -1;
+    memcpy(privkey_bech_output, PK_PREFIX, PK_PREFIX_LEN);
+
+    // 1. Scheme flag (0x00, Ed25519) and key, regrouped into 5-bit symbols
+    //    as they are read
+    for (size_t i = 0; i < 33; i++) {
+        acc = ((acc << 8) | (i == 0 ? 0x00 : privkey_bytes[i - 1])) & 0xfff;
+        bits += 8;
+        while (bits >= 5) {
+            bits -= 5;
+            v = (acc >> bits) & 0x1f;
+            *out++ = ALPHABET[v];
+            bech32_sum_push(&sum, v);
+        }
     }
+    v = (acc << (5 - bits)) & 0x1f; // last bits, zero padded
+    *out++ = ALPHABET[v];
+    bech32_sum_push(&sum, v);
 
-    for (size_t i = 0; i < hrp_len; i++) {
-        privkey_bech_output[i] = hrp[i];
+    // 2. Checksum over six zero symbols
+    for (int i = 0; i < PK_CHECKSUM_LEN; i++) {
+        bech32_sum_push(&sum, 0);
+    }
+    mod = bech32_sum_final(&sum) ^ 1;
+    for (int i = 0; i < PK_CHECKSUM_LEN; i++) {
+        *out++ = ALPHABET[(mod >> (5 * (5 - i))) & 0x1f];
     }
-    privkey_bech_output[hrp_len] = '1';
+    *out = '\0'; // null-terminator
 
-    size_t idx = hrp_len + 1;
-    for (size_t i = 0; i < data5_len; i++) {
-        privkey_bech_output[idx++] = ALPHABET[data5[i]];
+    crypto_wipe(&acc, sizeof(acc));
+    crypto_wipe(&v, sizeof(v));
+    return 0;
+}
+
+int microsui_decode_sui_privkeys(const char* const privkeys_bech[], uint8_t privkeys_bytes_output[][32],
+                                 size_t n, int results[]) {
+    int ret = 0;
+    for (size_t i = 0; i < n; i++) {
+        results[i] = microsui_decode_sui_privkey(privkeys_bech[i], privkeys_bytes_output[i]);
+        if (results[i] != 0) ret = -1;
     }
+    return ret;
+}
 
-    for (int i = 0; i < 6; i++) {
-        privkey_bech_output[idx++] = ALPHABET[checksum[i]];
+int microsui_encode_sui_privkeys(const uint8_t privkeys_bytes[][32],
+                                 char privkeys_bech_output[][MICROSUI_SUI_PRIVKEY_LEN + 1], size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        microsui_encode_sui_privkey(privkeys_bytes[i], privkeys_bech_output[i]);
     }
-    privkey_bech_output[idx] = '\0'; // null-terminator
     return 0;
-}
\ No newline at end of file
+}
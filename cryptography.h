@@ -1,8 +1,29 @@
 #ifndef CRYPTOGRAPHY_H
 #define CRYPTOGRAPHY_H
 
+#include <stdint.h>
+#include <stddef.h>
+
+// Characters of a Sui private key in Bech32 format ("suiprivkey1..."),
+// without the null terminator
+#define MICROSUI_SUI_PRIVKEY_LEN 70
+
+// Decodes a "suiprivkey1..." string (either case) and checks its checksum.
+// Returns 0 on success, -1 if the string is not a valid Sui private key.
 int microsui_decode_sui_privkey(const char *privkey_bech, uint8_t privkey_bytes_output[32]);
 
+// Writes the null-terminated Bech32 form of an Ed25519 private key, which
+// takes MICROSUI_SUI_PRIVKEY_LEN + 1 bytes. Returns 0.
 int microsui_encode_sui_privkey(const uint8_t *privkey_bytes, char *privkey_bech_output);
 
-#endif
\ No newline at end of file
+// Decodes n private key strings. results[i] is set to 0 if privkeys_bech[i]
+// was decoded into privkeys_bytes_output[i], -1 otherwise.
+// Returns 0 if every key was decoded, -1 otherwise.
+int microsui_decode_sui_privkeys(const char* const privkeys_bech[], uint8_t privkeys_bytes_output[][32],
+                                 size_t n, int results[]);
+
+// Encodes n private keys into null-terminated Bech32 strings. Returns 0.
+int microsui_encode_sui_privkeys(const uint8_t privkeys_bytes[][32],
+                                 char privkeys_bech_output[][MICROSUI_SUI_PRIVKEY_LEN + 1], size_t n);
+
+#endif
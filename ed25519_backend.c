@@ -0,0 +1,147 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "ed25519_backend.h"
+
+#if MICROSUI_ED25519_BACKEND == MICROSUI_ED25519_MONOCYPHER
+#include "monocypher/monocypher.h"
+
+// SHA-512 of up to three concatenated parts, reduced modulo L
+static void hash_reduce(uint8_t out[32],
+                        const uint8_t* a, size_t a_len,
+                        const uint8_t* b, size_t b_len,
+                        const uint8_t* c, size_t c_len) {
+    uint8_t hash[64];
+    crypto_sha512_ctx ctx;
+    crypto_sha512_init(&ctx);
+    crypto_sha512_update(&ctx, a, a_len);
+    crypto_sha512_update(&ctx, b, b_len);
+    crypto_sha512_update(&ctx, c, c_len);
+    crypto_sha512_final(&ctx, hash);
+    crypto_eddsa_reduce(out, hash);
+    crypto_wipe(hash, sizeof(hash));
+}
+
+void microsui_ed25519_expand_key(uint8_t expanded_key[64], const uint8_t private_key[32]) {
+    crypto_sha512(expanded_key, private_key, 32);
+    crypto_eddsa_trim_scalar(expanded_key, expanded_key);
+}
+
+void microsui_ed25519_public_key(uint8_t public_key[32], const uint8_t expanded_key[64]) {
+    crypto_eddsa_scalarbase(public_key, expanded_key);
+}
+
+void microsui_ed25519_sign(uint8_t signature[64], const uint8_t public_key[32], const uint8_t expanded_key[64],
+                           const uint8_t* message, size_t msg_len) {
+    uint8_t r[32]; // secret nonce
+    uint8_t h[32]; // challenge
+
+    // r = SHA-512(prefix || M) mod L, R = rB
+    hash_reduce(r, expanded_key + 32, 32, message, msg_len, NULL, 0);
+    crypto_eddsa_scalarbase(signature, r);
+
+    // h = SHA-512(R || A || M) mod L, S = h * a + r
+    hash_reduce(h, signature, 32, public_key, 32, message, msg_len);
+    crypto_eddsa_mul_add(signature + 32, h, expanded_key, r);
+
+    crypto_wipe(r, sizeof(r));
+}
+
+void microsui_ed25519_sign_batch(uint8_t signatures[][64], const uint8_t public_key[32],
+                                 const uint8_t expanded_key[64], const uint8_t* const messages[],
+                                 const size_t msg_lens[], size_t count) {
+    uint8_t r[MICROSUI_SIGN_BATCH_CHUNK][32]; // secret nonces
+    uint8_t R[MICROSUI_SIGN_BATCH_CHUNK][32];
+    uint8_t h[32];
+
+    // 1. r_i = SHA-512(prefix || M_i) mod L
+    for (size_t i = 0; i < count; i++) {
+        hash_reduce(r[i], expanded_key + 32, 32, messages[i], msg_lens[i], NULL, 0);
+    }
+
+    // 2. R_i = r_i B, all compressed with one inversion
+    crypto_eddsa_scalarbase_batch(R, (const uint8_t (*)[32])r, count);
+
+    // 3. h_i = SHA-512(R_i || A || M_i) mod L, S_i = h_i * a + r_i
+    for (size_t i = 0; i < count; i++) {
+        memcpy(signatures[i], R[i], 32);
+        hash_reduce(h, R[i], 32, public_key, 32, messages[i], msg_lens[i]);
+        crypto_eddsa_mul_add(signatures[i] + 32, h, expanded_key, r[i]);
+    }
+
+    crypto_wipe(r, sizeof(r));
+}
+
+int microsui_ed25519_verify(const uint8_t signature[64], const uint8_t public_key[32],
+                            const uint8_t* message, size_t msg_len) {
+    // h = SHA-512(R || A || M) mod L, then R == sB - hA with the
+    // sliding-window double-scalar multiplication
+    uint8_t h[32];
+    hash_reduce(h, signature, 32, public_key, 32, message, msg_len);
+    return crypto_eddsa_check_equation(signature, public_key, h);
+}
+
+int microsui_ed25519_verify_batch(const uint8_t* const signatures[], const uint8_t* const public_keys[],
+                                  const uint8_t* const messages[], const size_t msg_lens[], size_t count) {
+    uint8_t h_rams[MICROSUI_VERIFY_BATCH_CHUNK][32];
+    uint8_t weights[MICROSUI_VERIFY_BATCH_CHUNK][16];
+    uint8_t transcript[64];
+    crypto_blake2b_ctx ctx;
+
+    // 1. h_i = SHA-512(R_i || A_i || M_i) mod L, absorbed with the signatures into a transcript
+    crypto_blake2b_init(&ctx, 64);
+    for (size_t i = 0; i < count; i++) {
+        hash_reduce(h_rams[i], signatures[i], 32, public_keys[i], 32, messages[i], msg_lens[i]);
+        crypto_blake2b_update(&ctx, signatures[i], 64);
+        crypto_blake2b_update(&ctx, public_keys[i], 32);
+        crypto_blake2b_update(&ctx, h_rams[i], 32);
+    }
+    crypto_blake2b_final(&ctx, transcript);
+
+    // 2. Derive the 128-bit weights from the transcript, so that they cannot be
+    //    predicted before every signature of the batch is fixed
+    for (size_t i = 0; i < count; i++) {
+        uint8_t index[8] = {0};
+        for (int b = 0; b < 8; b++) index[b] = (uint8_t)((uint64_t)i >> (8 * b));
+        crypto_blake2b_keyed(weights[i], 16, transcript, sizeof(transcript), index, sizeof(index));
+    }
+
+    // 3. One multi-scalar multiplication for the whole batch
+    return crypto_eddsa_check_batch(signatures, public_keys, h_rams, weights, count);
+}
+
+#else
+#include "compact25519/c25519/edsign.h"
+
+void microsui_ed25519_expand_key(uint8_t expanded_key[64], const uint8_t private_key[32]) {
+    edsign_expand_key(expanded_key, private_key);
+}
+
+void microsui_ed25519_public_key(uint8_t public_key[32], const uint8_t expanded_key[64]) {
+    edsign_expanded_to_pub(public_key, expanded_key);
+}
+
+void microsui_ed25519_sign(uint8_t signature[64], const uint8_t public_key[32], const uint8_t expanded_key[64],
+                           const uint8_t* message, size_t msg_len) {
+    edsign_sign_expanded(signature, public_key, expanded_key, message, msg_len);
+}
+
+void microsui_ed25519_sign_batch(uint8_t signatures[][64], const uint8_t public_key[32],
+                                 const uint8_t expanded_key[64], const uint8_t* const messages[],
+                                 const size_t msg_lens[], size_t count) {
+    edsign_sign_expanded_batch(signatures[0], public_key, expanded_key, messages, msg_lens, (unsigned int)count);
+}
+
+int microsui_ed25519_verify(const uint8_t signature[64], const uint8_t public_key[32],
+                            const uint8_t* message, size_t msg_len) {
+    return edsign_verify(signature, public_key, message, msg_len) ? 0 : -1;
+}
+
+int microsui_ed25519_verify_batch(const uint8_t* const signatures[], const uint8_t* const public_keys[],
+                                  const uint8_t* const messages[], const size_t msg_lens[], size_t count) {
+    // No multi-scalar multiplication in compact25519, but on AVX2 hosts it
+    // checks four signatures per four-way double-scalar multiplication
+    return edsign_verify_batch(signatures, public_keys, messages, msg_lens, (unsigned int)count) ? 0 : -1;
+}
+
+#endif
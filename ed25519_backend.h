@@ -0,0 +1,34 @@
+#ifndef ED25519_BACKEND_H
+#define ED25519_BACKEND_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "microsui_config.h"
+
+// Ed25519 (SHA-512) primitives, implemented by the backend selected with
+// MICROSUI_ED25519_BACKEND. The expanded key is the clamped secret scalar
+// followed by the nonce prefix.
+
+void microsui_ed25519_expand_key(uint8_t expanded_key[64], const uint8_t private_key[32]);
+
+void microsui_ed25519_public_key(uint8_t public_key[32], const uint8_t expanded_key[64]);
+
+void microsui_ed25519_sign(uint8_t signature[64], const uint8_t public_key[32], const uint8_t expanded_key[64],
+                           const uint8_t* message, size_t msg_len);
+
+// Signs count messages with one key. The nonce points share a single field
+// inversion. count must not exceed MICROSUI_SIGN_BATCH_CHUNK.
+void microsui_ed25519_sign_batch(uint8_t signatures[][64], const uint8_t public_key[32],
+                                 const uint8_t expanded_key[64], const uint8_t* const messages[],
+                                 const size_t msg_lens[], size_t count);
+
+// Returns 0 if the signature is valid, -1 otherwise
+int microsui_ed25519_verify(const uint8_t signature[64], const uint8_t public_key[32],
+                            const uint8_t* message, size_t msg_len);
+
+// Returns 0 if all count signatures are valid, -1 if at least one is not.
+// count must not exceed MICROSUI_VERIFY_BATCH_CHUNK.
+int microsui_ed25519_verify_batch(const uint8_t* const signatures[], const uint8_t* const public_keys[],
+                                  const uint8_t* const messages[], const size_t msg_lens[], size_t count);
+
+#endif
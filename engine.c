@@ -0,0 +1,343 @@
+#include "engine.h"
+
+#if MICROSUI_ENABLE_THREADS
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "sign.h"
+#include "verify.h"
+
+#if (MICROSUI_ENGINE_QUEUE_SIZE & (MICROSUI_ENGINE_QUEUE_SIZE - 1)) != 0
+#error "MICROSUI_ENGINE_QUEUE_SIZE must be a power of two"
+#endif
+
+// Jobs a worker takes from a queue at once. Verify jobs taken together are
+// checked with one batch verification, sign jobs sharing a signer are signed
+// with one batch signature.
+#define ENGINE_GRAB MICROSUI_SIGN_BATCH_CHUNK
+
+#define ENGINE_CACHE_LINE 64
+
+// Bounded lock-free MPMC queue (Vyukov). Each cell carries a sequence number
+// telling producers and consumers whose turn it is, so a push or pop is one
+// CAS on the shared position plus one release store on the cell.
+typedef struct {
+    atomic_size_t seq;
+    microsui_job_t* job;
+} engine_cell_t;
+
+typedef struct {
+    _Alignas(ENGINE_CACHE_LINE) atomic_size_t push_pos;
+    _Alignas(ENGINE_CACHE_LINE) atomic_size_t pop_pos;
+    _Alignas(ENGINE_CACHE_LINE) engine_cell_t cells[MICROSUI_ENGINE_QUEUE_SIZE];
+} engine_ring_t;
+
+// One worker per thread, with its own queue and scratch space for batching.
+// Idle workers steal from the queues of the others.
+typedef struct {
+    engine_ring_t ring;
+    microsui_engine_t* engine;
+    unsigned int index;
+    pthread_t thread;
+    microsui_job_t* jobs[ENGINE_GRAB];
+    const uint8_t* sigs[ENGINE_GRAB];
+    const uint8_t* txs[ENGINE_GRAB];
+    size_t lens[ENGINE_GRAB];
+    int results[ENGINE_GRAB];
+    uint8_t signatures[ENGINE_GRAB][97];
+} engine_worker_t;
+
+struct microsui_engine {
+    engine_worker_t* workers;
+    unsigned int count;
+    _Alignas(ENGINE_CACHE_LINE) atomic_uint next;  // round-robin submission
+    _Alignas(ENGINE_CACHE_LINE) atomic_long queued; // jobs in the queues
+    atomic_int sleepers;
+    atomic_int waiters;
+    atomic_bool stop;
+    pthread_mutex_t lock;
+    pthread_cond_t wake; // idle workers
+    pthread_cond_t done; // microsui_engine_wait()
+};
+
+static void ring_init(engine_ring_t* ring) {
+    for (size_t i = 0; i < MICROSUI_ENGINE_QUEUE_SIZE; i++) {
+        atomic_init(&ring->cells[i].seq, i);
+        ring->cells[i].job = NULL;
+    }
+    atomic_init(&ring->push_pos, 0);
+    atomic_init(&ring->pop_pos, 0);
+}
+
+static int ring_push(engine_ring_t* ring, microsui_job_t* job) {
+    size_t pos = atomic_load_explicit(&ring->push_pos, memory_order_relaxed);
+    for (;;) {
+        engine_cell_t* cell = &ring->cells[pos & (MICROSUI_ENGINE_QUEUE_SIZE - 1)];
+        size_t seq = atomic_load_explicit(&cell->seq, memory_order_acquire);
+        intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&ring->push_pos, &pos, pos + 1,
+                                                      memory_order_relaxed, memory_order_relaxed)) {
+                cell->job = job;
+                atomic_store_explicit(&cell->seq, pos + 1, memory_order_release);
+                return 0;
+            }
+        } else if (diff < 0) {
+            return -1; // full
+        } else {
+            pos = atomic_load_explicit(&ring->push_pos, memory_order_relaxed);
+        }
+    }
+}
+
+static microsui_job_t* ring_pop(engine_ring_t* ring) {
+    size_t pos = atomic_load_explicit(&ring->pop_pos, memory_order_relaxed);
+    for (;;) {
+        engine_cell_t* cell = &ring->cells[pos & (MICROSUI_ENGINE_QUEUE_SIZE - 1)];
+        size_t seq = atomic_load_explicit(&cell->seq, memory_order_acquire);
+        intptr_t diff = (intptr_t)seq - (intptr_t)(pos + 1);
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&ring->pop_pos, &pos, pos + 1,
+                                                      memory_order_relaxed, memory_order_relaxed)) {
+                microsui_job_t* job = cell->job;
+                atomic_store_explicit(&cell->seq, pos + MICROSUI_ENGINE_QUEUE_SIZE, memory_order_release);
+                return job;
+            }
+        } else if (diff < 0) {
+            return NULL; // empty
+        } else {
+            pos = atomic_load_explicit(&ring->pop_pos, memory_order_relaxed);
+        }
+    }
+}
+
+static void job_complete(microsui_engine_t* engine, microsui_job_t* job, int result) {
+    job->result = result;
+    if (job->callback) job->callback(job, job->user);
+    __atomic_store_n(&job->done, 1, __ATOMIC_SEQ_CST);
+
+    // Wake microsui_engine_wait() only if someone is blocked in it
+    if (atomic_load(&engine->waiters) > 0) {
+        pthread_mutex_lock(&engine->lock);
+        pthread_cond_broadcast(&engine->done);
+        pthread_mutex_unlock(&engine->lock);
+    }
+}
+
+// Takes up to ENGINE_GRAB jobs, from the worker's own queue first and then
+// from the others, starting with its neighbour
+static size_t worker_grab(engine_worker_t* w) {
+    microsui_engine_t* engine = w->engine;
+    size_t n = 0;
+
+    for (unsigned int k = 0; k < engine->count && n == 0; k++) {
+        engine_ring_t* ring = &engine->workers[(w->index + k) % engine->count].ring;
+        microsui_job_t* job;
+        while (n < ENGINE_GRAB && (job = ring_pop(ring)) != NULL) {
+            w->jobs[n++] = job;
+        }
+    }
+    return n;
+}
+
+static void worker_run(engine_worker_t* w, size_t n) {
+    microsui_engine_t* engine = w->engine;
+    size_t m = 0;
+
+    // 1. All verify jobs in one batch verification
+    for (size_t i = 0; i < n; i++) {
+        microsui_job_t* job = w->jobs[i];
+        if (job->kind != MICROSUI_JOB_VERIFY) continue;
+        w->sigs[m] = job->signature;
+        w->txs[m] = job->tx_bytes;
+        w->lens[m] = job->tx_len;
+        m++;
+    }
+    if (m > 0) {
+        microsui_verify_batch(w->sigs, w->txs, w->lens, m, w->results);
+        m = 0;
+        for (size_t i = 0; i < n; i++) {
+            // A completed job may be freed by its owner at once, so drop it from the list
+            if (w->jobs[i]->kind != MICROSUI_JOB_VERIFY) continue;
+            microsui_job_t* job = w->jobs[i];
+            w->jobs[i] = NULL;
+            job_complete(engine, job, w->results[m++]);
+        }
+    }
+
+    // 2. Sign jobs, one batch signature per signer
+    for (size_t i = 0; i < n; i++) {
+        microsui_job_t* job = w->jobs[i];
+        if (job == NULL) continue;
+
+        microsui_job_t* group[ENGINE_GRAB];
+        m = 0;
+        for (size_t j = i; j < n; j++) {
+            microsui_job_t* other = w->jobs[j];
+            if (other == NULL || other->signer != job->signer) continue;
+            group[m] = other;
+            w->txs[m] = other->tx_bytes;
+            w->lens[m] = other->tx_len;
+            w->jobs[j] = NULL;
+            m++;
+        }
+
+        int result = microsui_sign_batch(job->signer, w->txs, w->lens, m, w->signatures);
+        for (size_t j = 0; j < m; j++) {
+            memcpy(group[j]->signature, w->signatures[j], 97);
+            job_complete(engine, group[j], result);
+        }
+    }
+}
+
+static void* worker_main(void* arg) {
+    engine_worker_t* w = (engine_worker_t*)arg;
+    microsui_engine_t* engine = w->engine;
+
+    for (;;) {
+        size_t n = worker_grab(w);
+        if (n > 0) {
+            atomic_fetch_sub(&engine->queued, (long)n);
+            worker_run(w, n);
+            continue;
+        }
+
+        // Nothing to do: sleep until a submission or shutdown. Announcing the
+        // sleeper before re-checking the count pairs with the submitter, which
+        // bumps the count before checking for sleepers, so no wake-up is lost.
+        pthread_mutex_lock(&engine->lock);
+        atomic_fetch_add(&engine->sleepers, 1);
+        while (atomic_load(&engine->queued) <= 0 && !atomic_load(&engine->stop)) {
+            pthread_cond_wait(&engine->wake, &engine->lock);
+        }
+        atomic_fetch_sub(&engine->sleepers, 1);
+        int finished = atomic_load(&engine->queued) <= 0 && atomic_load(&engine->stop);
+        pthread_mutex_unlock(&engine->lock);
+        if (finished) break;
+    }
+    return NULL;
+}
+
+void microsui_job_sign(microsui_job_t* job, microsui_signer_t* signer, const uint8_t* tx_bytes, size_t tx_len,
+                       microsui_job_callback_t callback, void* user) {
+    job->kind = MICROSUI_JOB_SIGN;
+    job->signer = signer;
+    job->tx_bytes = tx_bytes;
+    job->tx_len = tx_len;
+    job->callback = callback;
+    job->user = user;
+    job->result = -1;
+    job->done = 0;
+}
+
+void microsui_job_verify(microsui_job_t* job, const uint8_t signature[97], const uint8_t* tx_bytes, size_t tx_len,
+                         microsui_job_callback_t callback, void* user) {
+    job->kind = MICROSUI_JOB_VERIFY;
+    job->signer = NULL;
+    memcpy(job->signature, signature, 97);
+    job->tx_bytes = tx_bytes;
+    job->tx_len = tx_len;
+    job->callback = callback;
+    job->user = user;
+    job->result = -1;
+    job->done = 0;
+}
+
+microsui_engine_t* microsui_engine_create(unsigned int threads) {
+    if (threads == 0) {
+        long cores = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = cores > 0 ? (unsigned int)cores : 1;
+    }
+
+    microsui_engine_t* engine = (microsui_engine_t*)calloc(1, sizeof(*engine));
+    if (engine == NULL) return NULL;
+    engine->workers = (engine_worker_t*)aligned_alloc(ENGINE_CACHE_LINE, threads * sizeof(engine_worker_t));
+    if (engine->workers == NULL) {
+        free(engine);
+        return NULL;
+    }
+
+    atomic_init(&engine->next, 0);
+    atomic_init(&engine->queued, 0);
+    atomic_init(&engine->sleepers, 0);
+    atomic_init(&engine->waiters, 0);
+    atomic_init(&engine->stop, 0);
+    pthread_mutex_init(&engine->lock, NULL);
+    pthread_cond_init(&engine->wake, NULL);
+    pthread_cond_init(&engine->done, NULL);
+
+    for (unsigned int i = 0; i < threads; i++) {
+        ring_init(&engine->workers[i].ring);
+        engine->workers[i].engine = engine;
+        engine->workers[i].index = i;
+    }
+
+    // Workers read engine->count, so start them only once every queue exists
+    engine->count = threads;
+    for (unsigned int i = 0; i < threads; i++) {
+        if (pthread_create(&engine->workers[i].thread, NULL, worker_main, &engine->workers[i]) != 0) {
+            engine->count = i;
+            microsui_engine_destroy(engine);
+            return NULL;
+        }
+    }
+    return engine;
+}
+
+int microsui_engine_submit(microsui_engine_t* engine, microsui_job_t* job) {
+    unsigned int start = atomic_fetch_add_explicit(&engine->next, 1, memory_order_relaxed);
+
+    // Spread jobs round-robin, falling back to the next queue when one is full
+    for (unsigned int k = 0; k < engine->count; k++) {
+        if (ring_push(&engine->workers[(start + k) % engine->count].ring, job) == 0) {
+            atomic_fetch_add(&engine->queued, 1);
+            if (atomic_load(&engine->sleepers) > 0) {
+                pthread_mutex_lock(&engine->lock);
+                pthread_cond_signal(&engine->wake);
+                pthread_mutex_unlock(&engine->lock);
+            }
+            return 0;
+        }
+    }
+    return -1;
+}
+
+int microsui_job_done(const microsui_job_t* job) {
+    return __atomic_load_n(&job->done, __ATOMIC_SEQ_CST);
+}
+
+int microsui_engine_wait(microsui_engine_t* engine, microsui_job_t* job) {
+    if (!microsui_job_done(job)) {
+        atomic_fetch_add(&engine->waiters, 1);
+        pthread_mutex_lock(&engine->lock);
+        while (!microsui_job_done(job)) {
+            pthread_cond_wait(&engine->done, &engine->lock);
+        }
+        pthread_mutex_unlock(&engine->lock);
+        atomic_fetch_sub(&engine->waiters, 1);
+    }
+    return job->result;
+}
+
+void microsui_engine_destroy(microsui_engine_t* engine) {
+    pthread_mutex_lock(&engine->lock);
+    atomic_store(&engine->stop, 1);
+    pthread_cond_broadcast(&engine->wake);
+    pthread_mutex_unlock(&engine->lock);
+
+    for (unsigned int i = 0; i < engine->count; i++) {
+        pthread_join(engine->workers[i].thread, NULL);
+    }
+
+    pthread_cond_destroy(&engine->done);
+    pthread_cond_destroy(&engine->wake);
+    pthread_mutex_destroy(&engine->lock);
+    free(engine->workers);
+    free(engine);
+}
+
+#endif
@@ -0,0 +1,63 @@
+#ifndef ENGINE_H
+#define ENGINE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "microsui_config.h"
+#include "sign.h"
+
+#if MICROSUI_ENABLE_THREADS
+
+// Multi-threaded signing and verification for hosts with pthreads. Jobs are
+// owned by the caller: fill one in with microsui_job_sign() or
+// microsui_job_verify(), submit it, and keep it alive until it completes.
+// Completion is reported through the job's callback (run on a worker thread),
+// through microsui_engine_wait(), or both.
+
+typedef struct microsui_engine microsui_engine_t;
+typedef struct microsui_job microsui_job_t;
+
+typedef void (*microsui_job_callback_t)(microsui_job_t* job, void* user);
+
+typedef enum {
+    MICROSUI_JOB_SIGN,
+    MICROSUI_JOB_VERIFY,
+} microsui_job_kind_t;
+
+struct microsui_job {
+    microsui_job_kind_t kind;
+    microsui_signer_t* signer;         // sign jobs only, shared read-only
+    const uint8_t* tx_bytes;
+    size_t tx_len;
+    uint8_t signature[97];             // sign: output, verify: input
+    microsui_job_callback_t callback;  // optional
+    void* user;
+    int result;                        // 0 on success, -1 otherwise
+    int done;                          // set atomically by the engine, read with microsui_job_done()
+};
+
+void microsui_job_sign(microsui_job_t* job, microsui_signer_t* signer, const uint8_t* tx_bytes, size_t tx_len,
+                       microsui_job_callback_t callback, void* user);
+
+void microsui_job_verify(microsui_job_t* job, const uint8_t signature[97], const uint8_t* tx_bytes, size_t tx_len,
+                         microsui_job_callback_t callback, void* user);
+
+// Starts an engine with the given number of worker threads (0: one per online
+// core). Returns NULL if the threads or their queues cannot be created.
+microsui_engine_t* microsui_engine_create(unsigned int threads);
+
+// Queues a job. Returns 0 on success, -1 if every worker queue is full.
+int microsui_engine_submit(microsui_engine_t* engine, microsui_job_t* job);
+
+// Returns 1 if the job has completed, 0 otherwise, without blocking.
+int microsui_job_done(const microsui_job_t* job);
+
+// Blocks until the job has completed and returns its result.
+int microsui_engine_wait(microsui_engine_t* engine, microsui_job_t* job);
+
+// Runs every queued job to completion, then stops the workers and frees the engine.
+void microsui_engine_destroy(microsui_engine_t* engine);
+
+#endif
+
+#endif
@@ -0,0 +1,435 @@
+/* Host benchmark for the MicroSui signing and verification paths.
+ *
+ * Not part of the Arduino build (the IDE ignores extras/). Build from the
+ * library root, for example:
+ *
+ *   cc -O2 -I. extras/bench/bench.c sign.c verify.c utils.c \
+ *      cryptography.c ed25519_backend.c microsui_monocypher.c \
+ *      microsui_compact25519.c bcs.c -o microsui_bench
+ *
+ * and pick the code under test with the usual configuration macros, e.g.
+ * -DMICROSUI_ED25519_BACKEND=MICROSUI_ED25519_COMPACT together with
+ * -DF25519_BACKEND=F25519_BACKEND_BYTES / _LIMB32 / _LIMB64 and
+ * -DSHA512_BACKEND=SHA512_BACKEND_COMPACT / _WORD32 / _WORD64, or
+ * -DMICROSUI_CODEC_SIMD=0 for the scalar hex and base64 codecs.
+ *
+ * Add engine.c, -pthread and -DMICROSUI_ENABLE_THREADS=1 to also measure the
+ * worker pool's throughput for 1 to 16 threads.
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "MicroSui.h"
+#include "compact25519/c25519/ed25519.h"
+#include "compact25519/c25519/f25519.h"
+#include "compact25519/c25519/sha512.h"
+
+#define BENCH_TX_LEN 256
+
+static double bench_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static void bench_report(const char* name, double seconds, int iterations) {
+    printf("%-16s %10.2f us/op\n", name, seconds / iterations * 1e6);
+}
+
+static void bench_report_rate(const char* name, double seconds, double bytes) {
+    printf("%-16s %10.2f GB/s\n", name, bytes / seconds * 1e-9);
+}
+
+#if MICROSUI_ENABLE_THREADS
+#define BENCH_ENGINE_JOBS 512
+
+// Pushes every job through a fresh engine and returns the signatures per second
+static double bench_engine(unsigned int threads, microsui_job_t* jobs, int count, int* failures) {
+    microsui_engine_t* engine = microsui_engine_create(threads);
+    double start;
+    int i;
+
+    if (engine == NULL) {
+        (*failures)++;
+        return 0.0;
+    }
+    start = bench_now();
+    for (i = 0; i < count; i++) {
+        if (microsui_engine_submit(engine, &jobs[i]) != 0) (*failures)++;
+    }
+    for (i = 0; i < count; i++) {
+        if (microsui_engine_wait(engine, &jobs[i]) != 0) (*failures)++;
+    }
+    start = bench_now() - start;
+    microsui_engine_destroy(engine);
+    return count / start;
+}
+#endif
+
+int main(int argc, char** argv) {
+    int iterations = (argc > 1) ? atoi(argv[1]) : 200;
+    uint8_t seed[32];
+    uint8_t tx[BENCH_TX_LEN];
+    uint8_t sig[97];
+    microsui_signer_t signer;
+    double start;
+    int failures = 0;
+    int i;
+
+    if (iterations <= 0) iterations = 200;
+
+    for (i = 0; i < 32; i++) seed[i] = (uint8_t)(i * 7 + 1);
+    for (i = 0; i < BENCH_TX_LEN; i++) tx[i] = (uint8_t)(i * 13 + 5);
+
+    printf("ed25519 backend:  %s\n",
+           MICROSUI_ED25519_BACKEND == MICROSUI_ED25519_COMPACT ? "compact25519" : "monocypher");
+    printf("f25519 backend:   %s\n",
+           F25519_BACKEND == F25519_BACKEND_LIMB64 ? "limb64" :
+           F25519_BACKEND == F25519_BACKEND_LIMB32 ? "limb32" : "bytes");
+    printf("sha512 backend:   %s\n",
+           SHA512_BACKEND == SHA512_BACKEND_WORD64 ? "word64" :
+           SHA512_BACKEND == SHA512_BACKEND_WORD32 ? "word32" : "compact");
+    printf("tx length:        %d bytes, %d iterations\n", BENCH_TX_LEN, iterations);
+
+    // 1. Signing from the raw seed (key expansion on every call)
+    start = bench_now();
+    for (i = 0; i < iterations; i++) {
+        tx[0] = (uint8_t)i;
+        microsui_sign_tx_bytes(sig, tx, sizeof(tx), seed);
+    }
+    bench_report("keygen + sign", bench_now() - start, iterations);
+
+    // 2. Signing with a cached expanded key
+    microsui_signer_init(&signer, seed);
+    start = bench_now();
+    for (i = 0; i < iterations; i++) {
+        tx[0] = (uint8_t)i;
+        microsui_signer_sign_tx_bytes(&signer, sig, tx, sizeof(tx));
+    }
+    bench_report("sign", bench_now() - start, iterations);
+
+    // 3. Verification of the last signature
+    start = bench_now();
+    for (i = 0; i < iterations; i++) {
+        if (microsui_verify_signature(sig, tx, sizeof(tx)) != 0) failures++;
+    }
+    bench_report("verify", bench_now() - start, iterations);
+
+    // 4. The same through the batch APIs, MICROSUI_SIGN_BATCH_CHUNK at a time
+    {
+        static uint8_t txs[MICROSUI_SIGN_BATCH_CHUNK][BENCH_TX_LEN];
+        static uint8_t sigs[MICROSUI_SIGN_BATCH_CHUNK][97];
+        const uint8_t* tx_ptrs[MICROSUI_SIGN_BATCH_CHUNK];
+        const uint8_t* sig_ptrs[MICROSUI_SIGN_BATCH_CHUNK];
+        size_t lens[MICROSUI_SIGN_BATCH_CHUNK];
+        int results[MICROSUI_SIGN_BATCH_CHUNK];
+        int batches = (iterations + MICROSUI_SIGN_BATCH_CHUNK - 1) / MICROSUI_SIGN_BATCH_CHUNK;
+
+        for (i = 0; i < MICROSUI_SIGN_BATCH_CHUNK; i++) {
+            memcpy(txs[i], tx, BENCH_TX_LEN);
+            txs[i][0] = (uint8_t)i;
+            tx_ptrs[i] = txs[i];
+            sig_ptrs[i] = sigs[i];
+            lens[i] = BENCH_TX_LEN;
+        }
+
+        start = bench_now();
+        for (i = 0; i < batches; i++) {
+            if (microsui_sign_batch(&signer, tx_ptrs, lens, MICROSUI_SIGN_BATCH_CHUNK, sigs) != 0) failures++;
+        }
+        bench_report("sign batch", bench_now() - start, batches * MICROSUI_SIGN_BATCH_CHUNK);
+
+        start = bench_now();
+        for (i = 0; i < batches; i++) {
+            if (microsui_verify_batch(sig_ptrs, tx_ptrs, lens, MICROSUI_SIGN_BATCH_CHUNK, results) != 0) failures++;
+        }
+        bench_report("verify batch", bench_now() - start, batches * MICROSUI_SIGN_BATCH_CHUNK);
+    }
+
+    microsui_signer_destroy(&signer);
+
+    // 5. Transaction hashing alone: one message at a time, then 4 and 8 per
+    //    call through the multi-buffer BLAKE2b
+    {
+        static uint8_t txs[8][BENCH_TX_LEN];
+        uint8_t digests[8][32];
+        uint8_t* hashes[8];
+        const uint8_t* tx_ptrs[8];
+        size_t lens[8];
+        int messages = iterations * 64;
+
+        for (i = 0; i < 8; i++) {
+            memcpy(txs[i], tx, BENCH_TX_LEN);
+            txs[i][0] = (uint8_t)i;
+            hashes[i] = digests[i];
+            tx_ptrs[i] = txs[i];
+            lens[i] = BENCH_TX_LEN;
+        }
+
+        start = bench_now();
+        for (i = 0; i < messages; i++) {
+            crypto_blake2b(digests[i & 7], 32, txs[i & 7], BENCH_TX_LEN);
+        }
+        bench_report("blake2b", bench_now() - start, messages);
+
+        start = bench_now();
+        for (i = 0; i < messages; i += 4) {
+            crypto_blake2b_x4(hashes, 32, NULL, 0, tx_ptrs, lens);
+        }
+        bench_report("blake2b x4", bench_now() - start, messages);
+
+        start = bench_now();
+        for (i = 0; i < messages; i += 8) {
+            crypto_blake2b_x8(hashes, 32, NULL, 0, tx_ptrs, lens);
+        }
+        bench_report("blake2b x8", bench_now() - start, messages);
+
+#if !defined(COMPACT_DISABLE_ED25519) || !defined(COMPACT_DISABLE_X25519_DERIVE)
+        // compact25519's SHA-512, run three times per signature by edsign, and
+        // by monocypher too under MICROSUI_SHARED_SHA512
+        {
+            uint8_t sha_out[SHA512_HASH_SIZE];
+
+            start = bench_now();
+            for (i = 0; i < messages; i++) {
+                struct sha512_state hs;
+                size_t at;
+
+                sha512_init(&hs);
+                for (at = 0; at + SHA512_BLOCK_SIZE <= BENCH_TX_LEN; at += SHA512_BLOCK_SIZE) {
+                    sha512_block(&hs, txs[i & 7] + at);
+                }
+                sha512_final(&hs, txs[i & 7] + at, BENCH_TX_LEN);
+                sha512_get(&hs, sha_out, 0, SHA512_HASH_SIZE);
+            }
+            bench_report("sha512", bench_now() - start, messages);
+        }
+#if SHA512_X4
+        if (sha512x4_available()) {
+            uint8_t sha_out[4][SHA512_HASH_SIZE];
+            uint8_t* sha_ptrs[4] = { sha_out[0], sha_out[1], sha_out[2], sha_out[3] };
+
+            start = bench_now();
+            for (i = 0; i < messages; i += 4) {
+                sha512x4(sha_ptrs, tx_ptrs, 0, tx_ptrs + 4, lens);
+            }
+            bench_report("sha512 x4", bench_now() - start, messages);
+        }
+#endif
+#endif
+    }
+
+    // 6. suiprivkey import and export
+    {
+        char bech[MICROSUI_SUI_PRIVKEY_LEN + 1];
+        uint8_t key[32];
+        int keys = iterations * 64;
+
+        memcpy(key, seed, sizeof(key));
+        start = bench_now();
+        for (i = 0; i < keys; i++) {
+            key[0] = (uint8_t)i;
+            microsui_encode_sui_privkey(key, bech);
+        }
+        bench_report("privkey encode", bench_now() - start, keys);
+
+        start = bench_now();
+        for (i = 0; i < keys; i++) {
+            if (microsui_decode_sui_privkey(bech, key) != 0) failures++;
+        }
+        bench_report("privkey decode", bench_now() - start, keys);
+    }
+
+    // 7. Hex and base64 codec throughput, counted in bytes of binary data
+    {
+        static uint8_t bin[4095];
+        static char hex[2 * sizeof(bin) + 1];
+        static char b64[sizeof(bin) / 3 * 4 + 1];
+        size_t bin_len;
+        int rounds = iterations * 16;
+
+        for (i = 0; i < (int)sizeof(bin); i++) bin[i] = (uint8_t)(i * 31 + 7);
+
+        start = bench_now();
+        for (i = 0; i < rounds; i++) {
+            bin[0] = (uint8_t)i;
+            microsui_hex_encode(bin, sizeof(bin), hex);
+        }
+        bench_report_rate("hex encode", bench_now() - start, (double)rounds * sizeof(bin));
+
+        start = bench_now();
+        for (i = 0; i < rounds; i++) {
+            if (microsui_hex_decode(hex, bin, sizeof(bin), NULL) != 0) failures++;
+        }
+        bench_report_rate("hex decode", bench_now() - start, (double)rounds * sizeof(bin));
+
+        start = bench_now();
+        for (i = 0; i < rounds; i++) {
+            bin[0] = (uint8_t)i;
+            microsui_base64_encode(bin, sizeof(bin), b64);
+        }
+        bench_report_rate("base64 encode", bench_now() - start, (double)rounds * sizeof(bin));
+
+        start = bench_now();
+        for (i = 0; i < rounds; i++) {
+            if (microsui_base64_decode(b64, sizeof(b64) - 1, bin, &bin_len) != 0) failures++;
+        }
+        bench_report_rate("base64 decode", bench_now() - start, (double)rounds * sizeof(bin));
+    }
+
+    // 8. A SUI transfer (SplitCoins + TransferObjects) serialized with the
+    //    BCS writer, alone and hashed and signed while it is written, then
+    //    inspected through the view and patched as a template
+    {
+        static uint8_t arena[512];
+        microsui_bcs_writer_t w;
+        microsui_sign_ctx_t ctx;
+        microsui_object_ref_t coin;
+        microsui_gas_data_t gas;
+        microsui_arg_t amount = { MICROSUI_ARG_INPUT, 0, 0 };
+        microsui_arg_t recipient = { MICROSUI_ARG_INPUT, 1, 0 };
+        microsui_arg_t gas_coin = { MICROSUI_ARG_GAS_COIN, 0, 0 };
+        microsui_arg_t split = { MICROSUI_ARG_NESTED_RESULT, 0, 0 };
+        int j;
+
+        memcpy(coin.id, seed, 32);
+        coin.version = 123456;
+        memcpy(coin.digest, tx, 32);
+        gas.payment = &coin;
+        gas.payment_count = 1;
+        memcpy(gas.owner, tx + 32, 32);
+        gas.price = 1000;
+        gas.budget = 5000000;
+
+        for (j = 0; j < 2; j++) {
+            start = bench_now();
+            for (i = 0; i < iterations; i++) {
+                if (j) microsui_sign_init(&ctx);
+                microsui_bcs_init(&w, arena, sizeof(arena), j ? &ctx : NULL);
+                microsui_bcs_tx_begin(&w);
+                microsui_bcs_inputs(&w, 2);
+                microsui_bcs_input_u64(&w, 1000000 + (uint64_t)i);
+                microsui_bcs_input_address(&w, gas.owner);
+                microsui_bcs_commands(&w, 2);
+                microsui_bcs_split_coins(&w, gas_coin, &amount, 1);
+                microsui_bcs_transfer_objects(&w, &split, 1, recipient);
+                microsui_bcs_tx_end(&w, gas.owner, &gas, MICROSUI_BCS_NO_EXPIRATION);
+                if (microsui_bcs_finish(&w) != 0) failures++;
+                if (j && microsui_sign_final(&ctx, &signer, sig) != 0) failures++;
+            }
+            bench_report(j ? "bcs build + sign" : "bcs build", bench_now() - start, iterations);
+        }
+
+        // The last transfer read back: sender, budget, amount and recipient
+        start = bench_now();
+        for (i = 0; i < iterations * 16; i++) {
+            microsui_tx_view_t view;
+            uint64_t value;
+            const uint8_t* address;
+            if (microsui_tx_view_init(&view, arena, w.len) != 0 ||
+                microsui_tx_view_input_u64(&view, amount, &value) != 0 ||
+                microsui_tx_view_input_address(&view, recipient, &address) != 0 ||
+                microsui_tx_view_sender(&view)[0] != gas.owner[0] ||
+                microsui_tx_view_gas_budget(&view) != gas.budget) failures++;
+        }
+        bench_report("bcs view", bench_now() - start, iterations * 16);
+
+        // The same transfer as a template: amount, gas version and digest
+        // patched in place
+        {
+            microsui_tx_template_t t;
+            int amount_field, version_field, digest_field;
+
+            if (microsui_tx_template_init(&t, arena, w.len, sizeof(arena)) != 0) failures++;
+            amount_field = microsui_tx_template_input(&t, 0);
+            version_field = microsui_tx_template_gas_version(&t, 0);
+            digest_field = microsui_tx_template_gas_digest(&t, 0);
+
+            start = bench_now();
+            for (i = 0; i < iterations * 16; i++) {
+                if (microsui_tx_template_set_u64(&t, amount_field, 1000000 + (uint64_t)i) != 0 ||
+                    microsui_tx_template_set_u64(&t, version_field, 123456 + (uint64_t)i) != 0 ||
+                    microsui_tx_template_set(&t, digest_field, tx + (i & 63), 32) != 0) failures++;
+            }
+            bench_report("template patch", bench_now() - start, iterations * 16);
+        }
+    }
+
+#ifndef COMPACT_DISABLE_ED25519
+    // 9. compact25519 point compression (one inversion) and
+    //    decompression (one square root), as used by edsign
+    {
+        struct ed25519_pt pt;
+        uint8_t x[F25519_SIZE];
+        uint8_t y[F25519_SIZE];
+        uint8_t packed[ED25519_PACK_SIZE];
+        uint8_t e[ED25519_EXPONENT_SIZE];
+
+        memcpy(e, seed, sizeof(e));
+        ed25519_prepare(e);
+        ed25519_smult_base(&pt, e);
+
+        start = bench_now();
+        for (i = 0; i < iterations; i++) {
+            ed25519_unproject(x, y, &pt);
+            ed25519_pack(packed, x, y);
+        }
+        bench_report("point pack", bench_now() - start, iterations);
+
+        start = bench_now();
+        for (i = 0; i < iterations; i++) {
+            if (!ed25519_try_unpack(x, y, packed)) failures++;
+        }
+        bench_report("point unpack", bench_now() - start, iterations);
+    }
+#endif
+
+#if MICROSUI_ENABLE_THREADS
+    // 10. Throughput of the worker pool against the number of threads
+    {
+        static const unsigned int thread_counts[] = { 1, 2, 4, 8, 16 };
+        static microsui_job_t jobs[BENCH_ENGINE_JOBS];
+        static uint8_t txs[BENCH_ENGINE_JOBS][BENCH_TX_LEN];
+        static uint8_t sigs[BENCH_ENGINE_JOBS][97];
+        size_t t;
+
+        microsui_signer_init(&signer, seed);
+        for (i = 0; i < BENCH_ENGINE_JOBS; i++) {
+            memcpy(txs[i], tx, BENCH_TX_LEN);
+            txs[i][0] = (uint8_t)i;
+            txs[i][1] = (uint8_t)(i >> 8);
+        }
+
+        printf("threads          sign/s     verify/s\n");
+        for (t = 0; t < sizeof(thread_counts) / sizeof(thread_counts[0]); t++) {
+            double sign_rate, verify_rate;
+
+            for (i = 0; i < BENCH_ENGINE_JOBS; i++) {
+                microsui_job_sign(&jobs[i], &signer, txs[i], BENCH_TX_LEN, NULL, NULL);
+            }
+            sign_rate = bench_engine(thread_counts[t], jobs, BENCH_ENGINE_JOBS, &failures);
+            for (i = 0; i < BENCH_ENGINE_JOBS; i++) memcpy(sigs[i], jobs[i].signature, 97);
+
+            for (i = 0; i < BENCH_ENGINE_JOBS; i++) {
+                microsui_job_verify(&jobs[i], sigs[i], txs[i], BENCH_TX_LEN, NULL, NULL);
+            }
+            verify_rate = bench_engine(thread_counts[t], jobs, BENCH_ENGINE_JOBS, &failures);
+
+            printf("%-8u %12.0f %12.0f\n", thread_counts[t], sign_rate, verify_rate);
+        }
+        microsui_signer_destroy(&signer);
+    }
+#endif
+
+    if (failures != 0) {
+        printf("%d checks failed\n", failures);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,65 @@
+#!/usr/bin/env python3
+"""Generate bech32_table.h.
+
+The table folds two 5-bit symbols into the Bech32 checksum per lookup:
+bech32_polymod_table[x] is what the BCH generator adds to the checksum
+when its top 10 bits x are shifted out. The table is only compiled in
+under MICROSUI_BECH32_TABLE. The header also holds the checksum state
+after the expanded human-readable part "suiprivkey", so that the codec
+starts from it instead of hashing the prefix every time.
+
+Usage (from the library root):
+
+    python3 extras/tools/gen_bech32_table.py > bech32_table.h
+"""
+
+GEN = (0x3B6A57B2, 0x26508E6D, 0x1EA119FA, 0x3D4233DD, 0x2A1462B3)
+HRP = "suiprivkey"
+
+
+def polymod_step(c, v):
+    top = c >> 25
+    c = ((c & 0x1FFFFFF) << 5) ^ v
+    for j in range(5):
+        if (top >> j) & 1:
+            c ^= GEN[j]
+    return c
+
+
+def main():
+    table = [polymod_step(polymod_step(x << 20, 0), 0) for x in range(1024)]
+
+    state = 1
+    for v in [ord(ch) >> 5 for ch in HRP] + [0] + [ord(ch) & 31 for ch in HRP]:
+        state = polymod_step(state, v)
+
+    out = []
+    out.append("// Bech32 checksum tables")
+    out.append("//")
+    out.append("// Generated by extras/tools/gen_bech32_table.py. Do not edit.")
+    out.append("")
+    out.append("#ifndef BECH32_TABLE_H")
+    out.append("#define BECH32_TABLE_H")
+    out.append("")
+    out.append("#include <stdint.h>")
+    out.append("#include \"microsui_config.h\"")
+    out.append("")
+    out.append("// Checksum state after the expanded human-readable part \"%s\"" % HRP)
+    out.append("#define BECH32_SUIPRIVKEY_HRP_STATE 0x%08xUL" % state)
+    out.append("")
+    out.append("// bech32_polymod_table[x]: generator terms for the top 10 bits x of the")
+    out.append("// checksum, shifted out by two symbols. Entries 0 to 31 are the terms of")
+    out.append("// a single symbol.")
+    out.append("#if MICROSUI_BECH32_TABLE")
+    out.append("static const uint32_t bech32_polymod_table[1024] = {")
+    for i in range(0, 1024, 6):
+        out.append("    " + ", ".join("0x%08x" % t for t in table[i:i + 6]) + ",")
+    out.append("};")
+    out.append("#endif")
+    out.append("")
+    out.append("#endif")
+    print("\n".join(out))
+
+
+if __name__ == "__main__":
+    main()
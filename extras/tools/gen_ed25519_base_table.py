@@ -0,0 +1,96 @@
+#!/usr/bin/env python3
+"""Generate compact25519/c25519/ed25519_base_table.h.
+
+The table holds the multiples (j+1) * 16^(2k) * B, j = 0..7, k = 0..31, of
+the Ed25519 base point B in Niels form (y+x, y-x, 2dxy), each coordinate
+as 32 little-endian bytes. Rows are wrapped in preprocessor guards so that
+only the rows needed for the configured ED25519_BASE_COMB_ROWS are
+compiled in.
+
+Usage (from the library root):
+
+    python3 extras/tools/gen_ed25519_base_table.py \
+        > compact25519/c25519/ed25519_base_table.h
+"""
+
+P = 2**255 - 19
+D = (-121665 * pow(121666, P - 2, P)) % P
+BY = 4 * pow(5, P - 2, P) % P
+
+
+def recover_x(y, sign):
+    xx = (y * y - 1) * pow(D * y * y + 1, P - 2, P) % P
+    x = pow(xx, (P + 3) // 8, P)
+    if (x * x - xx) % P != 0:
+        x = x * pow(2, (P - 1) // 4, P) % P
+    if x & 1 != sign:
+        x = P - x
+    return x
+
+
+def add(a, b):
+    (x1, y1), (x2, y2) = a, b
+    t = D * x1 * x2 * y1 * y2 % P
+    x3 = (x1 * y2 + x2 * y1) * pow(1 + t, P - 2, P) % P
+    y3 = (y1 * y2 + x1 * x2) * pow(1 - t, P - 2, P) % P
+    return (x3, y3)
+
+
+def mul(k, pt):
+    r = (0, 1)
+    while k:
+        if k & 1:
+            r = add(r, pt)
+        pt = add(pt, pt)
+        k >>= 1
+    return r
+
+
+def c_bytes(v, indent):
+    b = v.to_bytes(32, "little")
+    lines = []
+    for i in range(0, 32, 8):
+        lines.append(indent + ", ".join("0x%02x" % c for c in b[i:i + 8]))
+    return ",\n".join(lines)
+
+
+def main():
+    base = (recover_x(BY, 0), BY)
+    out = []
+    out.append("/* Precomputed multiples of the Ed25519 base point")
+    out.append(" *")
+    out.append(" * Generated by extras/tools/gen_ed25519_base_table.py. Do not edit.")
+    out.append(" *")
+    out.append(" * This file is in the public domain.")
+    out.append(" */")
+    out.append("")
+    out.append("/* ed25519_base_comb[k][j] = (j+1) * 16^(2*row) * B, where row is the")
+    out.append(" * index of the guarded block below. Only every (32/ROWS)th block is")
+    out.append(" * compiled in, so k runs from 0 to ROWS-1.")
+    out.append(" */")
+    out.append("static const struct ed25519_niels")
+    out.append("ed25519_base_comb[ED25519_BASE_COMB_ROWS][8] = {")
+    row_base = base
+    for row in range(32):
+        out.append("#if ED25519_BASE_COMB_KEEP(%d)" % row)
+        out.append("\t{")
+        pt = row_base
+        for j in range(8):
+            x, y = pt
+            out.append("\t\t{ /* %d * 16^%d * B */" % (j + 1, 2 * row))
+            for name, v in (("ypx", (y + x) % P), ("ymx", (y - x) % P),
+                            ("xy2d", 2 * D * x * y % P)):
+                out.append("\t\t\t.%s = {" % name)
+                out.append(c_bytes(v, "\t\t\t\t"))
+                out.append("\t\t\t},")
+            out.append("\t\t},")
+            pt = add(pt, row_base)
+        out.append("\t},")
+        out.append("#endif")
+        row_base = mul(256, row_base)
+    out.append("};")
+    print("\n".join(out))
+
+
+if __name__ == "__main__":
+    main()
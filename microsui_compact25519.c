@@ -0,0 +1,19 @@
+// Compiles compact25519 as part of the library. The Arduino IDE only builds
+// the sources at the root of a flat library, so the files under compact25519/
+// are pulled in here, after the configuration that selects their features.
+
+#include "microsui_config.h"
+
+#include "compact25519/compact_ed25519.c"
+#include "compact25519/compact_x25519.c"
+#include "compact25519/compact_wipe.c"
+#include "compact25519/c25519/c25519.c"
+#include "compact25519/c25519/ed25519.c"
+#include "compact25519/c25519/edsign.c"
+#include "compact25519/c25519/f25519.c"
+#include "compact25519/c25519/f25519_limb32.c"
+#include "compact25519/c25519/f25519_limb64.c"
+#include "compact25519/c25519/f25519x4.c"
+#include "compact25519/c25519/fprime.c"
+#include "compact25519/c25519/sc25519.c"
+#include "compact25519/c25519/sha512.c"
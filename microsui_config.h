@@ -0,0 +1,183 @@
+#ifndef MICROSUI_CONFIG_H
+#define MICROSUI_CONFIG_H
+
+// Build-time configuration of MicroSui. Every option can be overridden with a
+// compiler flag (e.g. -DMICROSUI_ED25519_BACKEND=MICROSUI_ED25519_COMPACT) or
+// by editing the defaults below.
+
+// Ed25519 implementation used for key generation, signing and verification:
+//   MICROSUI_ED25519_MONOCYPHER: monocypher, fixed-base comb tables and radix
+//                                2^25.5 limbs. Fast, needs more flash.
+//   MICROSUI_ED25519_COMPACT:    compact25519, radix-16 ladder with optional
+//                                comb tables, field arithmetic picked by
+//                                F25519_BACKEND. Smaller, slower.
+#define MICROSUI_ED25519_MONOCYPHER 1
+#define MICROSUI_ED25519_COMPACT    2
+
+#ifndef MICROSUI_ED25519_BACKEND
+#define MICROSUI_ED25519_BACKEND MICROSUI_ED25519_MONOCYPHER
+#endif
+
+#if MICROSUI_ED25519_BACKEND != MICROSUI_ED25519_MONOCYPHER && \
+    MICROSUI_ED25519_BACKEND != MICROSUI_ED25519_COMPACT
+#error "MICROSUI_ED25519_BACKEND must be MICROSUI_ED25519_MONOCYPHER or MICROSUI_ED25519_COMPACT"
+#endif
+
+// Footprint of the firmware image. The library compiles compact25519 and
+// monocypher together, and each comes with its own SHA-512 and Ed25519 stack.
+//   MICROSUI_SHARED_SHA512: monocypher's crypto_sha512_*() run on
+//                           compact25519's sha512_block() (see SHA512_BACKEND),
+//                           so the image holds one SHA-512 core. This saves
+//                           flash only with the rolled SHA512_BACKEND_COMPACT
+//                           core; the unrolled ones are larger than
+//                           monocypher's, so by default sharing is on only
+//                           with the compact core.
+//   MICROSUI_SINGLE_ED25519: build only the Ed25519 code of the selected
+//                           backend: compact25519's edsign, Edwards point and
+//                           scalar arithmetic, or monocypher's EdDSA. X25519
+//                           stays available.
+#include "compact25519/c25519/sha512.h"
+#ifndef MICROSUI_SHARED_SHA512
+#define MICROSUI_SHARED_SHA512 (SHA512_BACKEND == SHA512_BACKEND_COMPACT)
+#endif
+#ifndef MICROSUI_SINGLE_ED25519
+#define MICROSUI_SINGLE_ED25519 1
+#endif
+
+#if MICROSUI_SINGLE_ED25519 && MICROSUI_ED25519_BACKEND == MICROSUI_ED25519_MONOCYPHER && \
+    !defined(COMPACT_DISABLE_ED25519)
+#define COMPACT_DISABLE_ED25519
+#endif
+
+// Monocypher features compiled into the library. MicroSui itself needs only
+// BLAKE2b and, with the monocypher backend, EdDSA over SHA-512; everything
+// else is opt-in.
+//   MICROSUI_WITH_AEAD:      crypto_aead_*(), ChaCha20 and Poly1305
+//   MICROSUI_WITH_ARGON2:    crypto_argon2()
+//   MICROSUI_WITH_X25519:    crypto_x25519*() and the EdDSA <--> X25519
+//                            conversions (compact25519's X25519 is separate)
+//   MICROSUI_WITH_ELLIGATOR: dirty public keys and Elligator 2, needs X25519
+//   MICROSUI_WITH_HMAC:      crypto_sha512_hmac_*() and crypto_sha512_hkdf*()
+#ifndef MICROSUI_WITH_AEAD
+#define MICROSUI_WITH_AEAD 0
+#endif
+#ifndef MICROSUI_WITH_ARGON2
+#define MICROSUI_WITH_ARGON2 0
+#endif
+#ifndef MICROSUI_WITH_X25519
+#define MICROSUI_WITH_X25519 0
+#endif
+#ifndef MICROSUI_WITH_ELLIGATOR
+#define MICROSUI_WITH_ELLIGATOR 0
+#endif
+#ifndef MICROSUI_WITH_HMAC
+#define MICROSUI_WITH_HMAC 0
+#endif
+
+#if !MICROSUI_WITH_AEAD && !defined(MONOCYPHER_NO_AEAD)
+#define MONOCYPHER_NO_AEAD
+#endif
+#if !MICROSUI_WITH_ARGON2 && !defined(MONOCYPHER_NO_ARGON2)
+#define MONOCYPHER_NO_ARGON2
+#endif
+#if !MICROSUI_WITH_X25519 && !defined(MONOCYPHER_NO_X25519)
+#define MONOCYPHER_NO_X25519
+#endif
+#if !MICROSUI_WITH_ELLIGATOR && !defined(MONOCYPHER_NO_ELLIGATOR)
+#define MONOCYPHER_NO_ELLIGATOR
+#endif
+// Monocypher's EdDSA and SHA-512 are the signer of the monocypher backend.
+// The compact backend keeps EdDSA only under MICROSUI_SINGLE_ED25519=0, and
+// SHA-512 only for HMAC.
+#if MICROSUI_ED25519_BACKEND != MICROSUI_ED25519_MONOCYPHER && MICROSUI_SINGLE_ED25519 && \
+    !defined(MONOCYPHER_NO_EDDSA)
+#define MONOCYPHER_NO_EDDSA
+#endif
+#if MICROSUI_ED25519_BACKEND != MICROSUI_ED25519_MONOCYPHER && !MICROSUI_WITH_HMAC && \
+    !defined(MONOCYPHER_NO_SHA512)
+#define MONOCYPHER_NO_SHA512
+#endif
+
+// compact25519 builds its SHA-512 for Ed25519 or for X25519 key derivation
+#if MICROSUI_SHARED_SHA512 && !defined(MONOCYPHER_SHA512_BLOCK) && \
+    (!defined(COMPACT_DISABLE_ED25519) || !defined(COMPACT_DISABLE_X25519_DERIVE))
+#define MONOCYPHER_SHA512_BLOCK(hash, block) \
+    sha512_block((struct sha512_state*)(hash), (block))
+#endif
+
+// Signatures combined into one multi-scalar multiplication by
+// microsui_verify_batch(). Larger chunks verify faster per signature, but
+// the call takes about 0.6 KB of stack plus 1.3 KB per signature (measured
+// with -fstack-usage on x86-64: 2.3 KB for 1, 5.9 KB for 4, 10.6 KB for 8,
+// 38 KB for 32). The default of 4 fits an 8 KB task stack such as the
+// ESP32 Arduino loop task; AVR boards, with 2 to 8 KB of SRAM in total,
+// verify one signature at a time. Chunks above 32 signatures switch from
+// Straus to Pippenger.
+#ifndef MICROSUI_VERIFY_BATCH_CHUNK
+#if defined(__AVR__)
+#define MICROSUI_VERIFY_BATCH_CHUNK 1
+#else
+#define MICROSUI_VERIFY_BATCH_CHUNK 4
+#endif
+#endif
+#ifndef CRYPTO_EDDSA_BATCH_CHUNK
+#define CRYPTO_EDDSA_BATCH_CHUNK MICROSUI_VERIFY_BATCH_CHUNK
+#endif
+
+// Transactions signed together by microsui_sign_batch(). Their nonce points
+// are compressed with one shared field inversion, at the cost of about
+// 300 bytes of stack per transaction (1.4 KB for 2, 3.7 KB for 8, measured
+// as above). AVR boards sign two at a time.
+#ifndef MICROSUI_SIGN_BATCH_CHUNK
+#if defined(__AVR__)
+#define MICROSUI_SIGN_BATCH_CHUNK 2
+#else
+#define MICROSUI_SIGN_BATCH_CHUNK 8
+#endif
+#endif
+#ifndef CRYPTO_EDDSA_SCALARBASE_CHUNK
+#define CRYPTO_EDDSA_SCALARBASE_CHUNK MICROSUI_SIGN_BATCH_CHUNK
+#endif
+#ifndef EDSIGN_BATCH_MAX
+#define EDSIGN_BATCH_MAX MICROSUI_SIGN_BATCH_CHUNK
+#endif
+
+// Variable fields a transaction template can record (microsui_tx_template_t),
+// 12 bytes each on 32-bit targets
+#ifndef MICROSUI_TEMPLATE_MAX_FIELDS
+#define MICROSUI_TEMPLATE_MAX_FIELDS 8
+#endif
+
+// Bech32 checksum of suiprivkey strings folded two symbols at a time through
+// a 4 KB table (bech32_table.h). AVR keeps constants in RAM, so it computes
+// the checksum bit by bit instead.
+#ifndef MICROSUI_BECH32_TABLE
+#if defined(__AVR__)
+#define MICROSUI_BECH32_TABLE 0
+#else
+#define MICROSUI_BECH32_TABLE 1
+#endif
+#endif
+
+// Vector hex and base64 codecs in utils.c: SSE4.1 and AVX2 kernels on x86
+// (picked at run time), NEON on ARM64. Set to 0 for the scalar code only.
+#ifndef MICROSUI_CODEC_SIMD
+#if ((defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)) || \
+    (defined(__aarch64__) && defined(__ARM_NEON))
+#define MICROSUI_CODEC_SIMD 1
+#else
+#define MICROSUI_CODEC_SIMD 0
+#endif
+#endif
+
+// Worker pool in engine.h for signing and verifying on several cores. Needs
+// pthreads and C11 atomics, so it is only for host builds. Each worker owns a
+// queue of MICROSUI_ENGINE_QUEUE_SIZE jobs (a power of two).
+#ifndef MICROSUI_ENABLE_THREADS
+#define MICROSUI_ENABLE_THREADS 0
+#endif
+#ifndef MICROSUI_ENGINE_QUEUE_SIZE
+#define MICROSUI_ENGINE_QUEUE_SIZE 1024
+#endif
+
+#endif
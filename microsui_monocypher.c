@@ -0,0 +1,7 @@
+// Compiles monocypher as part of the library. The Arduino IDE only builds the
+// sources at the root of a flat library, so the files under monocypher/ are
+// pulled in here, after the configuration that selects their features.
+
+#include "microsui_config.h"
+
+#include "monocypher/monocypher.c"
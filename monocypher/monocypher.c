@@ -53,6 +53,22 @@
 
 #include "monocypher.h"
 
+// Subsystems left out of the build when defined:
+//   MONOCYPHER_NO_AEAD      Chacha20, Poly1305, authenticated encryption,
+//                           crypto_elligator_key_pair()
+//   MONOCYPHER_NO_ARGON2    Argon2
+//   MONOCYPHER_NO_X25519    X25519 and the EdDSA <--> X25519 conversions
+//   MONOCYPHER_NO_ELLIGATOR dirty public keys, Elligator 2, scalar division
+//   MONOCYPHER_NO_EDDSA     EdDSA and the arithmetic modulo L
+//   MONOCYPHER_NO_SHA512    SHA 512, HMAC, HKDF, and Ed25519 on top of them
+// Their functions stay declared in monocypher.h; calling one that was left
+// out fails at link time.
+#if defined(MONOCYPHER_NO_X25519) || defined(MONOCYPHER_NO_EDDSA)
+#ifndef MONOCYPHER_NO_ELLIGATOR
+#define MONOCYPHER_NO_ELLIGATOR // built on both
+#endif
+#endif
+
 #ifdef MONOCYPHER_CPP_NAMESPACE
 namespace MONOCYPHER_CPP_NAMESPACE {
 #endif
@@ -77,7 +93,9 @@ typedef int32_t  i32;
 typedef int64_t  i64;
 typedef uint64_t u64;
 
+#if !defined(MONOCYPHER_NO_AEAD) || !defined(MONOCYPHER_NO_EDDSA)
 static const u8 zero[128] = {0};
+#endif
 
 // returns the smallest positive integer y such that
 // (x + y) % pow_2  == 0
@@ -89,6 +107,7 @@ static size_t gap(size_t x, size_t pow_2)
 	return (~x + 1) & (pow_2 - 1);
 }
 
+#if !defined(MONOCYPHER_NO_X25519) || !defined(MONOCYPHER_NO_EDDSA)
 static u32 load24_le(const u8 s[3])
 {
 	return
@@ -96,6 +115,7 @@ static u32 load24_le(const u8 s[3])
 		((u32)s[1] <<  8) |
 		((u32)s[2] << 16);
 }
+#endif
 
 static u32 load32_le(const u8 s[4])
 {
@@ -125,21 +145,29 @@ static void store64_le(u8 out[8], u64 in)
 	store32_le(out + 4, in >> 32);
 }
 
+#if !defined(MONOCYPHER_NO_AEAD) || !defined(MONOCYPHER_NO_EDDSA)
 static void load32_le_buf (u32 *dst, const u8 *src, size_t size) {
 	FOR(i, 0, size) { dst[i] = load32_le(src + i*4); }
 }
+#endif
 static void load64_le_buf (u64 *dst, const u8 *src, size_t size) {
 	FOR(i, 0, size) { dst[i] = load64_le(src + i*8); }
 }
+#if !defined(MONOCYPHER_NO_AEAD) || !defined(MONOCYPHER_NO_EDDSA)
 static void store32_le_buf(u8 *dst, const u32 *src, size_t size) {
 	FOR(i, 0, size) { store32_le(dst + i*4, src[i]); }
 }
+#endif
 static void store64_le_buf(u8 *dst, const u64 *src, size_t size) {
 	FOR(i, 0, size) { store64_le(dst + i*8, src[i]); }
 }
 
+#ifndef MONOCYPHER_NO_ARGON2
 static u64 rotr64(u64 x, u64 n) { return (x >> n) ^ (x << (64 - n)); }
+#endif
+#ifndef MONOCYPHER_NO_AEAD
 static u32 rotl32(u32 x, u32 n) { return (x << n) ^ (x >> (32 - n)); }
+#endif
 
 static int neq0(u64 diff)
 {
@@ -166,6 +194,7 @@ void crypto_wipe(void *secret, size_t size)
 	ZERO(v_secret, size);
 }
 
+#ifndef MONOCYPHER_NO_AEAD
 /////////////////
 /// Chacha 20 ///
 /////////////////
@@ -447,6 +476,7 @@ void crypto_poly1305(u8     mac[16],  const u8 *message,
 	crypto_poly1305_update(&ctx, message, message_size);
 	crypto_poly1305_final (&ctx, mac);
 }
+#endif
 
 ////////////////
 /// BLAKE2 b ///
@@ -458,23 +488,23 @@ static const u64 iv[8] = {
 	0x1f83d9abfb41bd6b, 0x5be0cd19137e2179,
 };
 
+static const u8 sigma[12][16] = {
+	{  0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14, 15 },
+	{ 14, 10,  4,  8,  9, 15, 13,  6,  1, 12,  0,  2, 11,  7,  5,  3 },
+	{ 11,  8, 12,  0,  5,  2, 15, 13, 10, 14,  3,  6,  7,  1,  9,  4 },
+	{  7,  9,  3,  1, 13, 12, 11, 14,  2,  6,  5, 10,  4,  0, 15,  8 },
+	{  9,  0,  5,  7,  2,  4, 10, 15, 14,  1, 11, 12,  6,  8,  3, 13 },
+	{  2, 12,  6, 10,  0, 11,  8,  3,  4, 13,  7,  5, 15, 14,  1,  9 },
+	{ 12,  5,  1, 15, 14, 13,  4, 10,  0,  7,  6,  3,  9,  2,  8, 11 },
+	{ 13, 11,  7, 14, 12,  1,  3,  9,  5,  0, 15,  4,  8,  6,  2, 10 },
+	{  6, 15, 14,  9, 11,  3,  0,  8, 12,  2, 13,  7,  1,  4, 10,  5 },
+	{ 10,  2,  8,  4,  7,  6,  1,  5, 15, 11,  9, 14,  3, 12, 13,  0 },
+	{  0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14, 15 },
+	{ 14, 10,  4,  8,  9, 15, 13,  6,  1, 12,  0,  2, 11,  7,  5,  3 },
+};
+
 static void blake2b_compress(crypto_blake2b_ctx *ctx, int is_last_block)
 {
-	static const u8 sigma[12][16] = {
-		{  0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14, 15 },
-		{ 14, 10,  4,  8,  9, 15, 13,  6,  1, 12,  0,  2, 11,  7,  5,  3 },
-		{ 11,  8, 12,  0,  5,  2, 15, 13, 10, 14,  3,  6,  7,  1,  9,  4 },
-		{  7,  9,  3,  1, 13, 12, 11, 14,  2,  6,  5, 10,  4,  0, 15,  8 },
-		{  9,  0,  5,  7,  2,  4, 10, 15, 14,  1, 11, 12,  6,  8,  3, 13 },
-		{  2, 12,  6, 10,  0, 11,  8,  3,  4, 13,  7,  5, 15, 14,  1,  9 },
-		{ 12,  5,  1, 15, 14, 13,  4, 10,  0,  7,  6,  3,  9,  2,  8, 11 },
-		{ 13, 11,  7, 14, 12,  1,  3,  9,  5,  0, 15,  4,  8,  6,  2, 10 },
-		{  6, 15, 14,  9, 11,  3,  0,  8, 12,  2, 13,  7,  1,  4, 10,  5 },
-		{ 10,  2,  8,  4,  7,  6,  1,  5, 15, 11,  9, 14,  3, 12, 13,  0 },
-		{  0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14, 15 },
-		{ 14, 10,  4,  8,  9, 15, 13,  6,  1, 12,  0,  2, 11,  7,  5,  3 },
-	};
-
 	// increment input offset
 	u64   *x = ctx->input_offset;
 	size_t y = ctx->input_idx;
@@ -495,11 +525,13 @@ static void blake2b_compress(crypto_blake2b_ctx *ctx, int is_last_block)
 
 	// mangle work vector
 	u64 *input = ctx->input;
+// Same as rotr64(), for the vector words of the multi-buffer kernels too
+#define BLAKE2_ROTR(x, n) (((x) >> (n)) ^ ((x) << (64 - (n))))
 #define BLAKE2_G(a, b, c, d, x, y)	\
-	a += b + x;  d = rotr64(d ^ a, 32); \
-	c += d;      b = rotr64(b ^ c, 24); \
-	a += b + y;  d = rotr64(d ^ a, 16); \
-	c += d;      b = rotr64(b ^ c, 63)
+	a += b + x;  d = BLAKE2_ROTR(d ^ a, 32); \
+	c += d;      b = BLAKE2_ROTR(b ^ c, 24); \
+	a += b + y;  d = BLAKE2_ROTR(d ^ a, 16); \
+	c += d;      b = BLAKE2_ROTR(b ^ c, 63)
 #define BLAKE2_ROUND(i)	\
 	BLAKE2_G(v0, v4, v8 , v12, input[sigma[i][ 0]], input[sigma[i][ 1]]); \
 	BLAKE2_G(v1, v5, v9 , v13, input[sigma[i][ 2]], input[sigma[i][ 3]]); \
@@ -650,6 +682,226 @@ void crypto_blake2b(u8 *hash, size_t hash_size, const u8 *msg, size_t msg_size)
 	crypto_blake2b_keyed(hash, hash_size, 0, 0, msg, msg_size);
 }
 
+/////////////////////////////
+/// BLAKE2 b multi-buffer ///
+/////////////////////////////
+// Each lane of a vector word hashes its own message. All lanes run the
+// same number of compressions, that of the longest message: a lane
+// that is done goes on compressing zeroes, after its hash was read.
+#if defined(__GNUC__) && !defined(BLAKE2_NO_SIMD) && \
+    (defined(__x86_64__) || defined(__i386__) || defined(__aarch64__))
+#define BLAKE2_SIMD 1
+#else
+#define BLAKE2_SIMD 0
+#endif
+
+#if BLAKE2_SIMD
+typedef u64 blake2_x4 __attribute__((vector_size(32)));
+typedef u64 blake2_x8 __attribute__((vector_size(64)));
+
+// Lane layout: word w of lane l is at words[w * lanes + l], so that
+// word w of all lanes is one vector.
+typedef void blake2b_lanes_fn(u64       *hash,
+                              const u64 *words,
+                              const u64 *offset,
+                              const u64 *is_last);
+
+// The twelve rounds, unrolled as in blake2b_compress()
+#ifdef BLAKE2_NO_UNROLLING
+#define BLAKE2_ROUNDS	FOR (i, 0, 12) { BLAKE2_ROUND(i); }
+#else
+#define BLAKE2_ROUNDS	\
+	BLAKE2_ROUND(0);  BLAKE2_ROUND(1);  BLAKE2_ROUND(2);  BLAKE2_ROUND(3); \
+	BLAKE2_ROUND(4);  BLAKE2_ROUND(5);  BLAKE2_ROUND(6);  BLAKE2_ROUND(7); \
+	BLAKE2_ROUND(8);  BLAKE2_ROUND(9);  BLAKE2_ROUND(10); BLAKE2_ROUND(11)
+#endif
+
+// Defines a compression kernel for vector type vec, compiled with
+// function attributes attr (e.g. to target AVX2).
+#define BLAKE2B_LANES_KERNEL(name, vec, attr)                          \
+	static attr void name(u64 *hash, const u64 *words,                \
+	                      const u64 *offset, const u64 *is_last)      \
+	{                                                                 \
+		const size_t lanes = sizeof(vec) / sizeof(u64);               \
+		const vec    z     = {0};                                     \
+		vec h[8], input[16], t, f;                                    \
+		FOR (i, 0, 8) {                                               \
+			__builtin_memcpy(&h[i], hash + i * lanes, sizeof(vec));   \
+		}                                                             \
+		FOR (i, 0, 16) {                                              \
+			__builtin_memcpy(&input[i], words + i * lanes, sizeof(vec)); \
+		}                                                             \
+		__builtin_memcpy(&t, offset , sizeof(vec));                   \
+		__builtin_memcpy(&f, is_last, sizeof(vec));                   \
+		vec v0 = h[0];  vec v8  = z + iv[0];                          \
+		vec v1 = h[1];  vec v9  = z + iv[1];                          \
+		vec v2 = h[2];  vec v10 = z + iv[2];                          \
+		vec v3 = h[3];  vec v11 = z + iv[3];                          \
+		vec v4 = h[4];  vec v12 = (z + iv[4]) ^ t;                    \
+		vec v5 = h[5];  vec v13 = z + iv[5];                          \
+		vec v6 = h[6];  vec v14 = (z + iv[6]) ^ f;                    \
+		vec v7 = h[7];  vec v15 = z + iv[7];                          \
+		BLAKE2_ROUNDS;                                                \
+		h[0] ^= v0 ^ v8;   h[1] ^= v1 ^ v9;                           \
+		h[2] ^= v2 ^ v10;  h[3] ^= v3 ^ v11;                          \
+		h[4] ^= v4 ^ v12;  h[5] ^= v5 ^ v13;                          \
+		h[6] ^= v6 ^ v14;  h[7] ^= v7 ^ v15;                          \
+		FOR (i, 0, 8) {                                               \
+			__builtin_memcpy(hash + i * lanes, &h[i], sizeof(vec));   \
+		}                                                             \
+	}
+
+// Portable kernels: the compiler maps the vectors to whatever the
+// target baseline has (SSE2, NEON), or to scalar code.
+BLAKE2B_LANES_KERNEL(blake2b_x4_generic, blake2_x4, )
+BLAKE2B_LANES_KERNEL(blake2b_x8_generic, blake2_x8, )
+
+#if defined(__x86_64__) || defined(__i386__)
+BLAKE2B_LANES_KERNEL(blake2b_x4_avx2   , blake2_x4, __attribute__((target("avx2"))))
+BLAKE2B_LANES_KERNEL(blake2b_x8_avx2   , blake2_x8, __attribute__((target("avx2"))))
+BLAKE2B_LANES_KERNEL(blake2b_x8_avx512 , blake2_x8, __attribute__((target("avx512f"))))
+#endif
+
+// Best kernel for this CPU
+static blake2b_lanes_fn *blake2b_kernel(size_t lanes)
+{
+#if defined(__x86_64__) || defined(__i386__)
+	if (lanes == 8 && __builtin_cpu_supports("avx512f")) {
+		return blake2b_x8_avx512;
+	}
+	if (__builtin_cpu_supports("avx2")) {
+		return lanes == 8 ? blake2b_x8_avx2 : blake2b_x4_avx2;
+	}
+#endif
+	return lanes == 8 ? blake2b_x8_generic : blake2b_x4_generic;
+}
+
+// Block at byte offset pos of prefix || message, zero padded, as words
+// of lane l
+static void blake2b_lane_block(u64 *words, size_t lanes, size_t l,
+                               const u8 *prefix , size_t prefix_size,
+                               const u8 *message, size_t message_size,
+                               size_t pos)
+{
+	if (pos >= prefix_size && pos - prefix_size + 128 <= message_size) {
+		// Whole block inside the message: read it in place
+		const u8 *src = message + (pos - prefix_size);
+		FOR (w, 0, 16) {
+			words[w * lanes + l] = load64_le(src + (w << 3));
+		}
+		return;
+	}
+	// Straddles the prefix or the end of the message: copy it out
+	u8 block[128];
+	ZERO(block, 128);
+	size_t n = 0;
+	if (pos < prefix_size) {
+		n = MIN(prefix_size - pos, 128);
+		COPY(block, prefix + pos, n);
+	}
+	size_t m_pos = pos + n - prefix_size;
+	if (n < 128 && m_pos < message_size) {
+		COPY(block + n, message + m_pos, MIN(message_size - m_pos, 128 - n));
+	}
+	FOR (w, 0, 16) {
+		words[w * lanes + l] = load64_le(block + (w << 3));
+	}
+	WIPE_BUFFER(block);
+}
+
+static void blake2b_lanes(u8 *const hashes[], size_t hash_size,
+                          const u8 *prefix, size_t prefix_size,
+                          const u8 *const messages[],
+                          const size_t message_sizes[], size_t lanes)
+{
+	blake2b_lanes_fn *kernel = blake2b_kernel(lanes);
+	u64    hash [8 * 8];
+	u64    words[16 * 8];
+	u64    offset [8];
+	u64    is_last[8];
+	size_t nb_blocks[8];
+	size_t max_blocks = 0;
+
+	FOR (l, 0, lanes) {
+		size_t size  = prefix_size + message_sizes[l];
+		nb_blocks[l] = size == 0 ? 1 : (size + 127) >> 7;
+		max_blocks   = MAX(max_blocks, nb_blocks[l]);
+		FOR (i, 0, 8) {
+			hash[i * lanes + l] = iv[i];
+		}
+		hash[l] ^= 0x01010000 ^ hash_size;
+	}
+
+	FOR (b, 0, max_blocks) {
+		FOR (l, 0, lanes) {
+			size_t size = prefix_size + message_sizes[l];
+			size_t pos  = b << 7;
+			int    live = b < nb_blocks[l];
+			if (live) {
+				blake2b_lane_block(words, lanes, l, prefix, prefix_size,
+				                   messages[l], message_sizes[l], pos);
+			} else {
+				FOR (w, 0, 16) {
+					words[w * lanes + l] = 0;
+				}
+			}
+			offset [l] = live ? MIN(size, pos + 128) : 0;
+			is_last[l] = b + 1 == nb_blocks[l] ? (u64)-1 : 0;
+		}
+		kernel(hash, words, offset, is_last);
+
+		// Read out the lanes that just compressed their last block
+		FOR (l, 0, lanes) {
+			if (b + 1 == nb_blocks[l]) {
+				FOR (i, 0, hash_size) {
+					hashes[l][i] = (hash[(i >> 3) * lanes + l]
+					                >> (8 * (i & 7))) & 0xff;
+				}
+			}
+		}
+	}
+	// Same as crypto_wipe(), a word at a time
+	volatile u64 *v_hash  = hash;
+	volatile u64 *v_words = words;
+	ZERO(v_hash , 8  * lanes);
+	ZERO(v_words, 16 * lanes);
+}
+#else
+// No vector extensions: one lane at a time
+static void blake2b_lanes(u8 *const hashes[], size_t hash_size,
+                          const u8 *prefix, size_t prefix_size,
+                          const u8 *const messages[],
+                          const size_t message_sizes[], size_t lanes)
+{
+	FOR (l, 0, lanes) {
+		crypto_blake2b_ctx ctx;
+		crypto_blake2b_init  (&ctx, hash_size);
+		crypto_blake2b_update(&ctx, prefix, prefix_size);
+		crypto_blake2b_update(&ctx, messages[l], message_sizes[l]);
+		crypto_blake2b_final (&ctx, hashes[l]);
+	}
+}
+#endif
+
+void crypto_blake2b_x4(u8 *const hashes[4], size_t hash_size,
+                       const u8 *prefix, size_t prefix_size,
+                       const u8 *const messages[4],
+                       const size_t message_sizes[4])
+{
+	blake2b_lanes(hashes, MIN(hash_size, 64), prefix, prefix_size,
+	              messages, message_sizes, 4);
+}
+
+void crypto_blake2b_x8(u8 *const hashes[8], size_t hash_size,
+                       const u8 *prefix, size_t prefix_size,
+                       const u8 *const messages[8],
+                       const size_t message_sizes[8])
+{
+	blake2b_lanes(hashes, MIN(hash_size, 64), prefix, prefix_size,
+	              messages, message_sizes, 8);
+}
+
+#ifndef MONOCYPHER_NO_ARGON2
 //////////////
 /// Argon2 ///
 //////////////
@@ -918,7 +1170,9 @@ void crypto_argon2(u8 *hash, u32 hash_size, void *work_area,
 	extended_hash(hash, hash_size, final_block, 1024);
 	WIPE_BUFFER(final_block);
 }
+#endif
 
+#if !defined(MONOCYPHER_NO_X25519) || !defined(MONOCYPHER_NO_EDDSA)
 ////////////////////////////////////
 /// Arithmetic modulo 2^255 - 19 ///
 ////////////////////////////////////
@@ -937,11 +1191,14 @@ typedef i32 fe[10];
 // lop_x, lop_y: low order point in Edwards coordinates
 // ufactor     : -sqrt(-1) * 2
 // A2          : 486662^2  (A squared)
+#ifndef MONOCYPHER_NO_X25519
 static const fe fe_one  = {1};
+#endif
 static const fe sqrtm1  = {
 	-32595792, -7943725, 9377950, 3500415, 12389472,
 	-272473, -25146209, -2005654, 326686, 11406482,
 };
+#ifndef MONOCYPHER_NO_EDDSA
 static const fe d       = {
 	-10913610, 13857413, -15372611, 6949391, 114729,
 	-8787816, -6275908, -3247719, -18696448, -12055116,
@@ -950,6 +1207,8 @@ static const fe D2      = {
 	-21827239, -5839606, -30745221, 13898782, 229458,
 	15978800, -12551817, -6495438, 29715968, 9444199,
 };
+#endif
+#ifndef MONOCYPHER_NO_ELLIGATOR
 static const fe lop_x   = {
 	21352778, 5345713, 4660180, -8347857, 24143090,
 	14568123, 30185756, -12247770, -33528939, 8345319,
@@ -965,6 +1224,7 @@ static const fe ufactor = {
 static const fe CRYPTO_A2      = {
 	12721188, 3529, 0, 0, 0, 0, 0, 0, 0, 0,
 };
+#endif
 
 static void fe_0(fe h) {           ZERO(h  , 10); }
 static void fe_1(fe h) { h[0] = 1; ZERO(h+1,  9); }
@@ -1324,6 +1584,7 @@ static void fe_sq(fe h, const fe f)
 	FE_CARRY;
 }
 
+#ifndef MONOCYPHER_NO_EDDSA
 //  Parity check.  Returns 0 if even, 1 if odd
 static int fe_isodd(const fe f)
 {
@@ -1333,6 +1594,7 @@ static int fe_isodd(const fe f)
 	WIPE_BUFFER(s);
 	return isodd;
 }
+#endif
 
 // Returns 1 if equal, 0 if not equal
 static int fe_isequal(const fe f, const fe g)
@@ -1480,7 +1742,9 @@ static int scalar_bit(const u8 s[32], int i)
 	if (i < 0) { return 0; } // handle -1 for sliding windows
 	return (s[i>>3] >> (i&7)) & 1;
 }
+#endif
 
+#ifndef MONOCYPHER_NO_X25519
 ///////////////
 /// X-25519 /// Taken from SUPERCOP's ref10 implementation.
 ///////////////
@@ -1560,7 +1824,9 @@ void crypto_x25519_public_key(u8       public_key[32],
 	static const u8 base_point[32] = {9};
 	crypto_x25519(public_key, secret_key, base_point);
 }
+#endif
 
+#ifndef MONOCYPHER_NO_EDDSA
 ///////////////////////////
 /// Arithmetic modulo L ///
 ///////////////////////////
@@ -2032,6 +2298,190 @@ int crypto_eddsa_check_equation(const u8 signature[64], const u8 public_key[32],
 	return crypto_verify32(check, zero_point);
 }
 
+// Batch verification
+// ------------------
+// Checks many signatures with a single multi-scalar multiplication:
+//
+//   [8]([sum(z_i * s_i)]B - sum([z_i]R_i) - sum([z_i * h_i]A_i)) == 0
+//
+// where the z_i are unpredictable 128-bit weights.  The equation is
+// cofactored, like crypto_eddsa_check_equation(), so a batch passes
+// exactly when every signature in it would pass on its own (except
+// with negligible probability over the choice of weights).
+//
+// Small batches use Straus (interleaved sliding windows), large ones use
+// Pippenger (signed buckets).  Batches are split in chunks of
+// CRYPTO_EDDSA_BATCH_CHUNK signatures to bound stack usage.
+//
+// Variable time!  Inputs must not be secret!
+#ifndef CRYPTO_EDDSA_BATCH_CHUNK
+#define CRYPTO_EDDSA_BATCH_CHUNK 64
+#endif
+#define BATCH_POINTS      (2 * CRYPTO_EDDSA_BATCH_CHUNK + 1)
+#define BATCH_STRAUS_MAX  32 // Signatures, above which Pippenger is faster
+#define BATCH_STRAUS_N    MIN(CRYPTO_EDDSA_BATCH_CHUNK, BATCH_STRAUS_MAX)
+#define BATCH_WINDOWS_MAX (256 / 4 + 1)
+
+// Straus: [s]B + sum([scalars_i]points_i), points_i in cached form
+static void batch_straus(ge *sum, const u8 s[32], const ge points[],
+                         const u8 scalars[][32], size_t nb_points)
+{
+	ge_cached lut[2 * BATCH_STRAUS_N][P_W_SIZE];
+	slide_ctx slides[2 * BATCH_STRAUS_N];
+	FOR (j, 0, nb_points) {
+		ge p2, tmp;
+		ge_double(&p2, &points[j], &tmp);
+		ge_cache(&lut[j][0], &points[j]);
+		FOR (i, 1, P_W_SIZE) {
+			ge_add(&tmp, &p2, &lut[j][i-1]);
+			ge_cache(&lut[j][i], &tmp);
+		}
+	}
+	slide_ctx s_slide;  slide_init(&s_slide, s);
+	int i = s_slide.next_check;
+	FOR (j, 0, nb_points) {
+		slide_init(&slides[j], scalars[j]);
+		i = MAX(i, slides[j].next_check);
+	}
+	ge_zero(sum);
+	while (i >= 0) {
+		ge tmp;
+		ge_double(sum, sum, &tmp);
+		FOR (j, 0, nb_points) {
+			int digit = slide_step(&slides[j], P_W_WIDTH, i, scalars[j]);
+			if (digit > 0) { ge_add(sum, sum, &lut[j][ digit / 2]); }
+			if (digit < 0) { ge_sub(sum, sum, &lut[j][-digit / 2]); }
+		}
+		fe t1, t2;
+		int s_digit = slide_step(&s_slide, B_W_WIDTH, i, s);
+		if (s_digit > 0) { ge_madd(sum, sum, b_window +  s_digit/2, t1, t2); }
+		if (s_digit < 0) { ge_msub(sum, sum, b_window + -s_digit/2, t1, t2); }
+		i--;
+	}
+}
+
+// Signed radix 2^width digits of a scalar below 2^253,
+// each in [-2^(width-1), 2^(width-1)].  Returns the number of digits.
+static int batch_recode(i8 digits[BATCH_WINDOWS_MAX], const u8 scalar[32],
+                        int width)
+{
+	int nb_windows = (253 + width) / width;
+	int carry      = 0;
+	FOR_T (int, w, 0, nb_windows) {
+		int v = carry;
+		FOR_T (int, j, 0, width) {
+			int bit = w * width + j;
+			if (bit < 256) {
+				v += scalar_bit(scalar, bit) << j;
+			}
+		}
+		carry = v > (1 << (width - 1));
+		digits[w] = (i8)(v - (carry << width));
+	}
+	return nb_windows;
+}
+
+// Pippenger: [s]B + sum([scalars_i]points_i)
+static void batch_pippenger(ge *sum, const u8 s[32], const ge points[],
+                            const u8 scalars[][32], size_t nb_points)
+{
+	i8        digits[BATCH_POINTS][BATCH_WINDOWS_MAX];
+	ge_cached cached[BATCH_POINTS];
+	ge        buckets[1 << 5];
+	int width      = nb_points < 32 ? 4 : nb_points < 96 ? 5 : 6;
+	int nb_buckets = 1 << (width - 1);
+	int nb_windows = 0;
+
+	// The base point is treated as one more point of the sum
+	fe_copy(cached[0].Yp, b_window[0].Yp);
+	fe_copy(cached[0].Ym, b_window[0].Ym);
+	fe_copy(cached[0].T2, b_window[0].T2);
+	fe_1   (cached[0].Z);
+	nb_windows = batch_recode(digits[0], s, width);
+	FOR (j, 0, nb_points) {
+		ge_cache(&cached[j + 1], &points[j]);
+		batch_recode(digits[j + 1], scalars[j], width);
+	}
+
+	ge_zero(sum);
+	for (int w = nb_windows - 1; w >= 0; w--) {
+		ge tmp;
+		FOR_T (int, k, 0, width) {
+			ge_double(sum, sum, &tmp);
+		}
+		FOR_T (int, b, 0, nb_buckets) {
+			ge_zero(&buckets[b]);
+		}
+		FOR (j, 0, nb_points + 1) {
+			int digit = digits[j][w];
+			if (digit > 0) { ge_add(&buckets[ digit-1], &buckets[ digit-1], &cached[j]); }
+			if (digit < 0) { ge_sub(&buckets[-digit-1], &buckets[-digit-1], &cached[j]); }
+		}
+		// sum += sum(b * buckets[b-1]), with a running sum
+		ge running;
+		ge_cached c;
+		ge_zero(&running);
+		for (int b = nb_buckets - 1; b >= 0; b--) {
+			ge_cache(&c, &buckets[b]);
+			ge_add(&running, &running, &c);
+			ge_cache(&c, &running);
+			ge_add(sum, sum, &c);
+		}
+	}
+}
+
+int crypto_eddsa_check_batch(const u8 *const signatures[],
+                             const u8 *const public_keys[],
+                             const u8 h_rams[][32],
+                             const u8 weights[][16], size_t count)
+{
+	static const u8 zero_point[32] = {1}; // Point of order 1
+	while (count > 0) {
+		size_t n = MIN(count, CRYPTO_EDDSA_BATCH_CHUNK);
+		ge points [2 * CRYPTO_EDDSA_BATCH_CHUNK];
+		u8 scalars[2 * CRYPTO_EDDSA_BATCH_CHUNK][32];
+		u8 s[32] = {0};
+
+		FOR (i, 0, n) {
+			// Check that A and R are on the curve and that 0 <= S < L
+			u32 s32[8];
+			load32_le_buf(s32, signatures[i] + 32, 8);
+			if (ge_frombytes_neg_vartime(&points[2*i  ], signatures[i]) ||
+			    ge_frombytes_neg_vartime(&points[2*i+1], public_keys[i]) ||
+			    is_above_l(s32)) {
+				return -1;
+			}
+			// -R_i gets z_i, -A_i gets z_i * h_i, B gets sum(z_i * s_i)
+			u8 z[32] = {0};
+			COPY(z, weights[i], 16);
+			COPY(scalars[2*i], z, 32);
+			crypto_eddsa_mul_add(scalars[2*i+1], z, h_rams[i], zero);
+			crypto_eddsa_mul_add(s, z, signatures[i] + 32, s);
+		}
+
+		ge sum, tmp;
+		u8 check[32];
+		if (n <= BATCH_STRAUS_MAX) {
+			batch_straus(&sum, s, points, scalars, 2 * n);
+		} else {
+			batch_pippenger(&sum, s, points, scalars, 2 * n);
+		}
+		ge_double(&sum, &sum, &tmp);
+		ge_double(&sum, &sum, &tmp);
+		ge_double(&sum, &sum, &tmp);
+		ge_tobytes(check, &sum);
+		if (crypto_verify32(check, zero_point)) {
+			return -1;
+		}
+		signatures  += n;
+		public_keys += n;
+		h_rams      += n;
+		weights     += n;
+		count       -= n;
+	}
+	return 0;
+}
+
 // 5-bit signed comb in cached format (Niels coordinates, Z=1)
 static const ge_precomp b_comb_low[8] = {
 	{{-6816601,-2324159,-22559413,124364,18015490,
@@ -2213,6 +2663,56 @@ void crypto_eddsa_scalarbase(u8 point[32], const u8 scalar[32])
 	WIPE_CTX(&P);
 }
 
+// Same as crypto_eddsa_scalarbase() for each scalar, but every chunk of
+// CRYPTO_EDDSA_SCALARBASE_CHUNK points is converted to affine coordinates
+// with one field inversion (Montgomery's trick) instead of one per point.
+#ifndef CRYPTO_EDDSA_SCALARBASE_CHUNK
+#define CRYPTO_EDDSA_SCALARBASE_CHUNK 8
+#endif
+void crypto_eddsa_scalarbase_batch(u8 points[][32], const u8 scalars[][32],
+                                   size_t count)
+{
+	while (count > 0) {
+		size_t n = MIN(count, CRYPTO_EDDSA_SCALARBASE_CHUNK);
+		ge P  [CRYPTO_EDDSA_SCALARBASE_CHUNK];
+		fe acc[CRYPTO_EDDSA_SCALARBASE_CHUNK]; // acc[i] = Z_0 * ... * Z_i
+		fe inv, recip, x, y;
+
+		FOR (i, 0, n) {
+			ge_scalarmult_base(&P[i], scalars[i]);
+		}
+		fe_copy(acc[0], P[0].Z);
+		FOR (i, 1, n) {
+			fe_mul(acc[i], acc[i-1], P[i].Z);
+		}
+		fe_invert(inv, acc[n-1]);
+
+		// Walk back: recip = 1/Z_i, then strip Z_i from inv
+		for (size_t i = n; i-- > 0; ) {
+			if (i > 0) {
+				fe_mul(recip, inv, acc[i-1]);
+				fe_mul(inv, inv, P[i].Z);
+			} else {
+				fe_copy(recip, inv);
+			}
+			fe_mul(x, P[i].X, recip);
+			fe_mul(y, P[i].Y, recip);
+			fe_tobytes(points[i], y);
+			points[i][31] ^= fe_isodd(x) << 7;
+		}
+
+		WIPE_BUFFER(P);
+		WIPE_BUFFER(acc);
+		WIPE_BUFFER(inv);
+		WIPE_BUFFER(recip);
+		WIPE_BUFFER(x);
+		WIPE_BUFFER(y);
+		points  += n;
+		scalars += n;
+		count   -= n;
+	}
+}
+
 void crypto_eddsa_key_pair(u8 secret_key[64], u8 public_key[32], u8 seed[32])
 {
 	// To allow overlaps, observable writes happen in this order:
@@ -2245,6 +2745,7 @@ static void hash_reduce(u8 h[32],
 	crypto_eddsa_reduce(h, hash);
 }
 
+#ifndef MONOCYPHER_NO_SHA512
 static void hash_reduce_expanded(u8 h[32],
                         const u8 *a, size_t a_size,
                         const u8 *b, size_t b_size,
@@ -2261,6 +2762,7 @@ static void hash_reduce_expanded(u8 h[32],
 	crypto_blake2b_final (&ctx, hash);
 	crypto_eddsa_reduce(h, hash);
 }
+#endif
 
 // Digital signature of a message with from a secret key.
 //
@@ -2352,7 +2854,9 @@ int crypto_eddsa_check(const u8  signature[64], const u8 public_key[32],
 	hash_reduce(h, signature, 32, public_key, 32, message, message_size);
 	return crypto_eddsa_check_equation(signature, public_key, h);
 }
+#endif
 
+#ifndef MONOCYPHER_NO_X25519
 /////////////////////////
 /// EdDSA <--> X25519 ///
 /////////////////////////
@@ -2385,7 +2889,9 @@ void crypto_x25519_to_eddsa(u8 eddsa[32], const u8 x25519[32])
 	WIPE_BUFFER(t1);
 	WIPE_BUFFER(t2);
 }
+#endif
 
+#ifndef MONOCYPHER_NO_ELLIGATOR
 /////////////////////////////////////////////
 /// Dirty ephemeral public key generation ///
 /////////////////////////////////////////////
@@ -2728,6 +3234,7 @@ int crypto_elligator_rev(u8 hidden[32], const u8 public_key[32], u8 tweak)
 	return is_square - 1;
 }
 
+#ifndef MONOCYPHER_NO_AEAD // needs Chacha20
 void crypto_elligator_key_pair(u8 hidden[32], u8 secret_key[32], u8 seed[32])
 {
 	u8 pk [32]; // public key
@@ -2749,7 +3256,10 @@ void crypto_elligator_key_pair(u8 hidden[32], u8 secret_key[32], u8 seed[32])
 	WIPE_BUFFER(buf);
 	WIPE_BUFFER(pk);
 }
+#endif
+#endif
 
+#ifndef MONOCYPHER_NO_ELLIGATOR
 ///////////////////////
 /// Scalar division ///
 ///////////////////////
@@ -2868,7 +3378,9 @@ void crypto_x25519_inverse(u8 blind_salt [32], const u8 private_key[32],
 	WIPE_BUFFER(scalar);   WIPE_BUFFER(m_scl);
 	WIPE_BUFFER(product);  WIPE_BUFFER(m_inv);
 }
+#endif
 
+#ifndef MONOCYPHER_NO_AEAD
 ////////////////////////////////
 /// Authenticated encryption ///
 ////////////////////////////////
@@ -2967,8 +3479,10 @@ int crypto_aead_unlock(u8 *plain_text, const u8  mac[16], const u8 key[32],
 	crypto_wipe(&ctx, sizeof(ctx));
 	return mismatch;
 }
+#endif
 
 
+#ifndef MONOCYPHER_NO_SHA512
 /////////////////
 ///  ED25519  ///
 /////////////////
@@ -3014,6 +3528,21 @@ static void load64_be_buf (u64 *dst, const u8 *src, size_t size) {
 ///////////////
 /// SHA 512 ///
 ///////////////
+#ifdef MONOCYPHER_SHA512_BLOCK
+// The compression function is supplied by the embedding project, so that
+// a firmware image holds only one SHA-512 core.
+// MONOCYPHER_SHA512_BLOCK(hash, block) compresses the 128 bytes of block
+// into the eight state words of hash.
+static void sha512_compress(crypto_sha512_ctx *ctx)
+{
+	u8 block[128];
+	FOR (i, 0, 16) {
+		store64_be(block + i*8, ctx->input[i]);
+	}
+	MONOCYPHER_SHA512_BLOCK(ctx->hash, block);
+	WIPE_BUFFER(block);
+}
+#else
 static u64 rot(u64 x, int c       ) { return (x >> c) | (x << (64 - c));   }
 static u64 ch (u64 x, u64 y, u64 z) { return (x & y) ^ (~x & z);           }
 static u64 maj(u64 x, u64 y, u64 z) { return (x & y) ^ ( x & z) ^ (y & z); }
@@ -3079,6 +3608,7 @@ static void sha512_compress(crypto_sha512_ctx *ctx)
 	ctx->hash[4] += e;    ctx->hash[5] += f;
 	ctx->hash[6] += g;    ctx->hash[7] += h;
 }
+#endif
 
 // Write 1 input byte
 static void sha512_set_input(crypto_sha512_ctx *ctx, u8 input)
@@ -3311,7 +3841,9 @@ void crypto_sha512_hkdf(u8       *okm , size_t okm_size,
 	// Expand
 	crypto_sha512_hkdf_expand(okm, okm_size, prk, sizeof(prk), info, info_size);
 }
+#endif
 
+#if !defined(MONOCYPHER_NO_SHA512) && !defined(MONOCYPHER_NO_EDDSA)
 ///////////////
 /// Ed25519 ///
 ///////////////
@@ -3380,6 +3912,7 @@ int crypto_ed25519_ph_check(const uint8_t sig[64], const uint8_t pk[32],
 	hash_reduce_expanded(h_ram, domain, sizeof(domain), sig, 32, pk, 32, msg_hash, 64);
 	return crypto_eddsa_check_equation(sig, pk, h_ram);
 }
+#endif
 
 
 #ifdef MONOCYPHER_CPP_NAMESPACE
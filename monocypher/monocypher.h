@@ -148,6 +148,23 @@ void crypto_blake2b_update(crypto_blake2b_ctx *ctx,
                            const uint8_t *message, size_t message_size);
 void crypto_blake2b_final(crypto_blake2b_ctx *ctx, uint8_t *hash);
 
+// Multi-buffer interface: 4 or 8 unrelated messages hashed at once, one
+// per SIMD lane (AVX2 or AVX-512 where the CPU has them, a portable
+// fallback otherwise). hashes[i] = BLAKE2b(prefix || messages[i]); the
+// optional prefix is shared by all lanes so callers needn't copy it in
+// front of each message. Lanes finish with the longest message, so
+// messages of similar sizes work best.
+void crypto_blake2b_x4(uint8_t       *const hashes       [4],
+                       size_t               hash_size,
+                       const uint8_t       *prefix, size_t prefix_size,
+                       const uint8_t *const messages     [4],
+                       const size_t         message_sizes[4]);
+void crypto_blake2b_x8(uint8_t       *const hashes       [8],
+                       size_t               hash_size,
+                       const uint8_t       *prefix, size_t prefix_size,
+                       const uint8_t *const messages     [8],
+                       const size_t         message_sizes[8]);
+
 
 // Password key derivation (Argon2)
 // --------------------------------
@@ -237,9 +254,17 @@ void crypto_eddsa_mul_add(uint8_t r[32],
                           const uint8_t b[32],
                           const uint8_t c[32]);
 void crypto_eddsa_scalarbase(uint8_t point[32], const uint8_t scalar[32]);
+void crypto_eddsa_scalarbase_batch(uint8_t       points [][32],
+                                   const uint8_t scalars[][32],
+                                   size_t        count);
 int crypto_eddsa_check_equation(const uint8_t signature[64],
                                 const uint8_t public_key[32],
                                 const uint8_t h_ram[32]);
+int crypto_eddsa_check_batch(const uint8_t *const signatures [],
+                             const uint8_t *const public_keys[],
+                             const uint8_t        h_rams     [][32],
+                             const uint8_t        weights    [][16],
+                             size_t               count);
 
 
 // Chacha20
@@ -3,54 +3,181 @@
 #include <string.h>
 #include <stdlib.h>
 #include <stdbool.h>
+#include "sign.h"
 #include "utils.h"
+#include "ed25519_backend.h"
 #include "monocypher/monocypher.h"
-#include "compact25519/compact_ed25519.h"
 
-size_t build_message_with_intent(uint8_t *tx_bytes, size_t tx_len, uint8_t *output) {
-    size_t offset = 0;
+// Hex input is decoded through a small stack buffer in chunks of this size
+#define HEX_CHUNK_SIZE 64
 
-    // Setting Intent
-    output[offset++] = 0x00; // scope: 0x00 is TransactionData (we need this in this case)
-    output[offset++] = 0x00; // version: V0
-    output[offset++] = 0x00; // appId: Sui
+// Base64 input is decoded in chunks of this many characters (96 bytes)
+#define B64_CHUNK_SIZE 128
 
-    // Copying tx_bytes in output
-    memcpy(output + offset, tx_bytes, tx_len);
-    offset += tx_len;
+static void sign_digest(microsui_signer_t* signer, const uint8_t digest[32], uint8_t sui_sig[97]) {
+    // 1. Sign the digest using Ed25519 with the expanded key and public key
+    uint8_t ed25519_signature[64];
+    microsui_ed25519_sign(ed25519_signature, signer->public_key, signer->expanded_key, digest, 32);
 
-    return offset; // Total length of messageWithIntent
+    // 2. Build Sui signature
+    sui_sig[0] = 0x00;  // Ed25519 Scheme
+    memcpy(sui_sig + 1, ed25519_signature, 64);
+    memcpy(sui_sig + 65, signer->public_key, 32);
 }
 
-int microsui_sign_message(uint8_t sui_sig[97], const char* message_hex, const uint8_t private_key[32]) {
-    // 1. Convert the HEX message to binary bytes
-    size_t msg_len = strlen(message_hex) / 2;  // 2 hex chars = 1 byte
-    uint8_t* message = (uint8_t*)malloc(msg_len);
-    hex_to_bytes(message_hex, message, msg_len);
-
-    uint8_t private_key_cp[32];
-    memcpy(private_key_cp, private_key, 32);
-
-    // 2. Generate public key
-    uint8_t public_key[32];
-    uint8_t secret_key[64];
-    crypto_ed25519_key_pair(secret_key, public_key, private_key_cp);
-
-    // 3. Generate digest using BLAKE2b with the message whit the intent
-    uint8_t message_with_intent[512];
-    size_t message_with_intent_len = build_message_with_intent(message, msg_len, message_with_intent);
-    uint8_t digest[32];
-    crypto_blake2b(digest, 32, message_with_intent, message_with_intent_len);
+int microsui_signer_init(microsui_signer_t* signer, const uint8_t private_key[32]) {
+    // 1. Expand the private key: SHA-512 of the seed, clamped scalar || nonce prefix
+    microsui_ed25519_expand_key(signer->expanded_key, private_key);
 
-    // 4. Sign the digest using Ed25519 with the private key and public key
-    uint8_t ed25519_signature[64];
-    compact_ed25519_sign(ed25519_signature, secret_key, digest, 32);
+    // 2. Generate public key from the clamped scalar
+    microsui_ed25519_public_key(signer->public_key, signer->expanded_key);
 
-    // 5. Build Sui signature
-    sui_sig[0] = 0x00;  // Ed25519 Scheme
-    memcpy(sui_sig + 1, ed25519_signature, 64);
-    memcpy(sui_sig + 65, public_key, 32);
+    return 0;
+}
+
+int microsui_signer_sign(microsui_signer_t* signer, uint8_t sui_sig[97], const char* message_hex) {
+    microsui_sign_ctx_t ctx;
+    uint8_t chunk[HEX_CHUNK_SIZE];
+    size_t hex_len = strlen(message_hex);
+    size_t msg_len = hex_len / 2;  // 2 hex chars = 1 byte
+
+    // A corrupted message is rejected rather than signed
+    if (hex_len % 2 != 0) return -1;
+
+    // Decode the HEX message chunk by chunk straight into the intent hash
+    microsui_sign_init(&ctx);
+    while (msg_len > 0) {
+        size_t n = msg_len < HEX_CHUNK_SIZE ? msg_len : HEX_CHUNK_SIZE;
+        if (microsui_hex_decode(message_hex, chunk, n, NULL) != 0) {
+            crypto_wipe(&ctx, sizeof(ctx));
+            return -1;
+        }
+        microsui_sign_update(&ctx, chunk, n);
+        message_hex += 2 * n;
+        msg_len -= n;
+    }
+    return microsui_sign_final(&ctx, signer, sui_sig);
+}
+
+int microsui_signer_sign_base64(microsui_signer_t* signer, char sig_b64[MICROSUI_SIGNATURE_BASE64_LEN + 1],
+                                const char* tx_b64) {
+    microsui_sign_ctx_t ctx;
+    uint8_t chunk[B64_CHUNK_SIZE / 4 * 3];
+    size_t b64_len = strlen(tx_b64);
+
+    if (b64_len % 4 != 0) return -1;
+
+    // Decode the base64 transaction chunk by chunk straight into the intent
+    // hash. Only the last chunk may end in padding.
+    microsui_sign_init(&ctx);
+    while (b64_len > 0) {
+        size_t n = b64_len < B64_CHUNK_SIZE ? b64_len : B64_CHUNK_SIZE;
+        size_t len;
+        if (microsui_base64_decode(tx_b64, n, chunk, &len) != 0 || (n < b64_len && len != n / 4 * 3)) {
+            crypto_wipe(&ctx, sizeof(ctx));
+            return -1;
+        }
+        microsui_sign_update(&ctx, chunk, len);
+        tx_b64 += n;
+        b64_len -= n;
+    }
+    return microsui_sign_final_base64(&ctx, signer, sig_b64);
+}
+
+int microsui_signer_sign_tx_bytes(microsui_signer_t* signer, uint8_t sui_sig[97], const uint8_t* tx_bytes, size_t tx_len) {
+    // Raw BCS bytes are hashed in place, no copy and no allocation
+    microsui_sign_ctx_t ctx;
+    microsui_sign_init(&ctx);
+    microsui_sign_update(&ctx, tx_bytes, tx_len);
+    return microsui_sign_final(&ctx, signer, sui_sig);
+}
+
+int microsui_sign_batch(microsui_signer_t* signer, const uint8_t* const tx_bytes[], const size_t tx_lens[],
+                        size_t n, uint8_t signatures[][97]) {
+    uint8_t digests[MICROSUI_SIGN_BATCH_CHUNK][32];
+    uint8_t ed25519_signatures[MICROSUI_SIGN_BATCH_CHUNK][64];
+    const uint8_t* messages[MICROSUI_SIGN_BATCH_CHUNK];
+    size_t msg_lens[MICROSUI_SIGN_BATCH_CHUNK];
+
+    while (n > 0) {
+        size_t count = n < MICROSUI_SIGN_BATCH_CHUNK ? n : MICROSUI_SIGN_BATCH_CHUNK;
+
+        // 1. BLAKE2b digests of the intent messages, several lanes at a time
+        microsui_tx_digests(digests, tx_bytes, tx_lens, count);
+        for (size_t i = 0; i < count; i++) {
+            messages[i] = digests[i];
+            msg_lens[i] = 32;
+        }
 
-    free(message);
+        // 2. Sign the whole chunk with the expanded key
+        microsui_ed25519_sign_batch(ed25519_signatures, signer->public_key, signer->expanded_key,
+                                    messages, msg_lens, count);
+
+        // 3. Build the Sui signatures
+        for (size_t i = 0; i < count; i++) {
+            signatures[i][0] = 0x00;  // Ed25519 Scheme
+            memcpy(signatures[i] + 1, ed25519_signatures[i], 64);
+            memcpy(signatures[i] + 65, signer->public_key, 32);
+        }
+
+        tx_bytes += count;
+        tx_lens += count;
+        signatures += count;
+        n -= count;
+    }
+    return 0;
+}
+
+void microsui_signer_destroy(microsui_signer_t* signer) {
+    crypto_wipe(signer, sizeof(*signer));
+}
+
+void microsui_sign_init(microsui_sign_ctx_t* ctx) {
+    microsui_tx_digest_init(&ctx->hash);
+}
+
+void microsui_sign_update(microsui_sign_ctx_t* ctx, const uint8_t* tx_chunk, size_t chunk_len) {
+    crypto_blake2b_update(&ctx->hash, tx_chunk, chunk_len);
+}
+
+int microsui_sign_final(microsui_sign_ctx_t* ctx, microsui_signer_t* signer, uint8_t sui_sig[97]) {
+    // BLAKE2b digest of the intent message, then sign it
+    uint8_t digest[32];
+    crypto_blake2b_final(&ctx->hash, digest);
+    sign_digest(signer, digest, sui_sig);
+    return 0;
+}
+
+int microsui_sign_final_base64(microsui_sign_ctx_t* ctx, microsui_signer_t* signer,
+                               char sig_b64[MICROSUI_SIGNATURE_BASE64_LEN + 1]) {
+    // Serialized signature (flag || signature || public key), as Sui RPC takes it
+    uint8_t sui_sig[97];
+    microsui_sign_final(ctx, signer, sui_sig);
+    microsui_base64_encode(sui_sig, sizeof(sui_sig), sig_b64);
     return 0;
 }
+
+int microsui_sign_message(uint8_t sui_sig[97], const char* message_hex, const uint8_t private_key[32]) {
+    microsui_signer_t signer;
+    microsui_signer_init(&signer, private_key);
+    int ret = microsui_signer_sign(&signer, sui_sig, message_hex);
+    microsui_signer_destroy(&signer);
+    return ret;
+}
+
+int microsui_sign_message_base64(char sig_b64[MICROSUI_SIGNATURE_BASE64_LEN + 1], const char* tx_b64,
+                                 const uint8_t private_key[32]) {
+    microsui_signer_t signer;
+    microsui_signer_init(&signer, private_key);
+    int ret = microsui_signer_sign_base64(&signer, sig_b64, tx_b64);
+    microsui_signer_destroy(&signer);
+    return ret;
+}
+
+int microsui_sign_tx_bytes(uint8_t sui_sig[97], const uint8_t* tx_bytes, size_t tx_len, const uint8_t private_key[32]) {
+    microsui_signer_t signer;
+    microsui_signer_init(&signer, private_key);
+    int ret = microsui_signer_sign_tx_bytes(&signer, sui_sig, tx_bytes, tx_len);
+    microsui_signer_destroy(&signer);
+    return ret;
+}
@@ -1,6 +1,67 @@
 #ifndef SIGN_H
 #define SIGN_H
 
+#include <stdint.h>
+#include <stddef.h>
+#include "monocypher/monocypher.h"
+
+// Characters of a serialized Sui signature in base64, without the null terminator
+#define MICROSUI_SIGNATURE_BASE64_LEN 132
+
+// Signer context: holds the key material derived from a private key so that
+// it is computed once instead of on every signature.
+typedef struct {
+    uint8_t expanded_key[64]; // clamped scalar || nonce prefix (SHA-512 of the seed)
+    uint8_t public_key[32];
+} microsui_signer_t;
+
+// Streaming sign context: the BLAKE2b state of the intent message. Its size
+// is fixed, so transactions of any length can be signed without buffering.
+typedef struct {
+    crypto_blake2b_ctx hash;
+} microsui_sign_ctx_t;
+
+// Signs the transaction bytes given as hex. Returns -1, without signing, if
+// message_hex is not an even number of hex digits.
 int microsui_sign_message(uint8_t signature[97], const char* message_hex, const uint8_t private_key[32]);
 
+// Signs the transaction bytes given as base64, the txBytes of Sui JSON-RPC,
+// and writes the serialized signature (flag || signature || public key) as
+// null-terminated base64. The input is decoded chunk by chunk straight into
+// the intent hash. Returns -1, without signing, if tx_b64 is not valid base64.
+int microsui_sign_message_base64(char signature_b64[MICROSUI_SIGNATURE_BASE64_LEN + 1], const char* tx_b64,
+                                 const uint8_t private_key[32]);
+
+int microsui_sign_tx_bytes(uint8_t signature[97], const uint8_t* tx_bytes, size_t tx_len, const uint8_t private_key[32]);
+
+int microsui_signer_init(microsui_signer_t* signer, const uint8_t private_key[32]);
+
+// As microsui_sign_message(), with the key material of signer
+int microsui_signer_sign(microsui_signer_t* signer, uint8_t signature[97], const char* message_hex);
+
+// As microsui_sign_message_base64(), with the key material of signer
+int microsui_signer_sign_base64(microsui_signer_t* signer, char signature_b64[MICROSUI_SIGNATURE_BASE64_LEN + 1],
+                                const char* tx_b64);
+
+int microsui_signer_sign_tx_bytes(microsui_signer_t* signer, uint8_t signature[97], const uint8_t* tx_bytes, size_t tx_len);
+
+void microsui_signer_destroy(microsui_signer_t* signer);
+
+// Signs n transactions with one signer. Key material is reused across the batch
+// and the signatures are computed in chunks of MICROSUI_SIGN_BATCH_CHUNK, whose
+// nonce points share a single field inversion. signatures[i] receives the Sui
+// signature of tx_bytes[i]. Returns 0 on success.
+int microsui_sign_batch(microsui_signer_t* signer, const uint8_t* const tx_bytes[], const size_t tx_lens[],
+                        size_t n, uint8_t signatures[][97]);
+
+void microsui_sign_init(microsui_sign_ctx_t* ctx);
+
+void microsui_sign_update(microsui_sign_ctx_t* ctx, const uint8_t* tx_chunk, size_t chunk_len);
+
+int microsui_sign_final(microsui_sign_ctx_t* ctx, microsui_signer_t* signer, uint8_t signature[97]);
+
+// As microsui_sign_final(), writing the signature as null-terminated base64
+int microsui_sign_final_base64(microsui_sign_ctx_t* ctx, microsui_signer_t* signer,
+                               char signature_b64[MICROSUI_SIGNATURE_BASE64_LEN + 1]);
+
 #endif
\ No newline at end of file
@@ -3,29 +3,601 @@
 #include <string.h>
 #include <stdlib.h>
 #include <stdbool.h>
+#include "utils.h"
+#include "microsui_config.h"
+#include "monocypher/monocypher.h"
+
+#if MICROSUI_CODEC_SIMD && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define CODEC_X86 1
+#define CODEC_SSE41 __attribute__((target("sse4.1")))
+#define CODEC_AVX2  __attribute__((target("avx2")))
+#elif MICROSUI_CODEC_SIMD && defined(__aarch64__)
+#include <arm_neon.h>
+#define CODEC_NEON 1
+#endif
 
 static const char hex_digits[] = "0123456789abcdef";
 
+// Value of a hex digit in either case, 0xff for any other character
 static inline uint8_t hex_val(char c) {
-    if (c >= '0' && c <= '9') return c - '0';
-    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
-    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
-    return 0;
+    uint8_t d = (uint8_t)c - '0';
+    uint8_t a = ((uint8_t)c | 0x20) - 'a';
+    if (d <= 9) return d;
+    if (a <= 5) return a + 10;
+    return 0xff;
 }
 
-void hex_to_bytes(const char* hex_str, uint8_t* bytes, uint32_t bytes_len) {
-    for (uint32_t i = 0; i < bytes_len; i++) {
+// Decodes up to n bytes and stops before the first pair with an invalid
+// digit. Returns the number of bytes decoded.
+static size_t hex_decode_scalar(const char* hex_str, uint8_t* bytes, size_t n) {
+    size_t i;
+    for (i = 0; i < n; i++) {
         uint8_t hi = hex_val(hex_str[2*i    ]);
         uint8_t lo = hex_val(hex_str[2*i + 1]);
+        if ((hi | lo) & 0xf0) break;
         bytes[i] = (hi << 4) | lo;
     }
+    return i;
 }
 
-void bytes_to_hex(const uint8_t* bytes, uint32_t bytes_len, char* hex_str) {
-    for (uint32_t i = 0; i < bytes_len; i++) {
+static void hex_encode_scalar(const uint8_t* bytes, size_t n, char* hex_str) {
+    for (size_t i = 0; i < n; i++) {
         uint8_t b = bytes[i];
         hex_str[2*i    ] = hex_digits[(b >> 4) & 0x0F];
         hex_str[2*i + 1] = hex_digits[b & 0x0F];
     }
+}
+
+#ifdef CODEC_X86
+// The vector kernels work like the scalar ones on whole blocks: they stop
+// before the first block that holds an invalid digit and leave it to the
+// scalar code, which finds the exact offset.
+//
+// Per character c: d = c - '0' and a = (c | 0x20) - 'a', as unsigned bytes.
+// c is a digit if d <= 9 and a letter if a <= 5; its value is d or a + 10.
+// maddubs then merges each pair of nibbles into hi * 16 + lo.
+static CODEC_SSE41 size_t hex_decode_sse41(const char* hex_str, uint8_t* bytes, size_t n) {
+    const __m128i zero_char = _mm_set1_epi8('0');
+    const __m128i a_char    = _mm_set1_epi8('a');
+    const __m128i lower     = _mm_set1_epi8(0x20);
+    const __m128i nine      = _mm_set1_epi8(9);
+    const __m128i five      = _mm_set1_epi8(5);
+    const __m128i ten       = _mm_set1_epi8(10);
+    const __m128i weights   = _mm_set1_epi16(0x0110);
+    size_t i = 0;
+
+    for (; n - i >= 8; i += 8) {
+        __m128i c = _mm_loadu_si128((const __m128i*)(hex_str + 2*i));
+        __m128i d = _mm_sub_epi8(c, zero_char);
+        __m128i a = _mm_sub_epi8(_mm_or_si128(c, lower), a_char);
+        __m128i is_digit  = _mm_cmpeq_epi8(_mm_min_epu8(d, nine), d);
+        __m128i is_letter = _mm_cmpeq_epi8(_mm_min_epu8(a, five), a);
+        __m128i v;
+
+        if (!_mm_test_all_ones(_mm_or_si128(is_digit, is_letter))) break;
+        v = _mm_blendv_epi8(_mm_add_epi8(a, ten), d, is_digit);
+        v = _mm_maddubs_epi16(v, weights);
+        _mm_storel_epi64((__m128i*)(bytes + i), _mm_packus_epi16(v, v));
+    }
+    return i;
+}
+
+static CODEC_AVX2 size_t hex_decode_avx2(const char* hex_str, uint8_t* bytes, size_t n) {
+    const __m256i zero_char = _mm256_set1_epi8('0');
+    const __m256i a_char    = _mm256_set1_epi8('a');
+    const __m256i lower     = _mm256_set1_epi8(0x20);
+    const __m256i nine      = _mm256_set1_epi8(9);
+    const __m256i five      = _mm256_set1_epi8(5);
+    const __m256i ten       = _mm256_set1_epi8(10);
+    const __m256i weights   = _mm256_set1_epi16(0x0110);
+    size_t i = 0;
+
+    for (; n - i >= 16; i += 16) {
+        __m256i c = _mm256_loadu_si256((const __m256i*)(hex_str + 2*i));
+        __m256i d = _mm256_sub_epi8(c, zero_char);
+        __m256i a = _mm256_sub_epi8(_mm256_or_si256(c, lower), a_char);
+        __m256i is_digit  = _mm256_cmpeq_epi8(_mm256_min_epu8(d, nine), d);
+        __m256i is_letter = _mm256_cmpeq_epi8(_mm256_min_epu8(a, five), a);
+        __m256i v;
+
+        if (_mm256_movemask_epi8(_mm256_or_si256(is_digit, is_letter)) != -1) break;
+        v = _mm256_blendv_epi8(_mm256_add_epi8(a, ten), d, is_digit);
+        v = _mm256_maddubs_epi16(v, weights);
+        // packus works per 128-bit lane: gather the low half of each lane
+        v = _mm256_permute4x64_epi64(_mm256_packus_epi16(v, v), 0x08);
+        _mm_storeu_si128((__m128i*)(bytes + i), _mm256_castsi256_si128(v));
+    }
+    return i;
+}
+
+// Each byte is split into its two nibbles, interleaved high first, and
+// pshufb looks the nibbles up in hex_digits
+static CODEC_SSE41 size_t hex_encode_sse41(const uint8_t* bytes, size_t n, char* hex_str) {
+    const __m128i digits = _mm_loadu_si128((const __m128i*)hex_digits);
+    const __m128i mask   = _mm_set1_epi8(0x0f);
+    size_t i = 0;
+
+    for (; n - i >= 16; i += 16) {
+        __m128i b  = _mm_loadu_si128((const __m128i*)(bytes + i));
+        __m128i hi = _mm_and_si128(_mm_srli_epi16(b, 4), mask);
+        __m128i lo = _mm_and_si128(b, mask);
+        _mm_storeu_si128((__m128i*)(hex_str + 2*i     ), _mm_shuffle_epi8(digits, _mm_unpacklo_epi8(hi, lo)));
+        _mm_storeu_si128((__m128i*)(hex_str + 2*i + 16), _mm_shuffle_epi8(digits, _mm_unpackhi_epi8(hi, lo)));
+    }
+    return i;
+}
+
+static CODEC_AVX2 size_t hex_encode_avx2(const uint8_t* bytes, size_t n, char* hex_str) {
+    const __m256i digits = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)hex_digits));
+    const __m256i mask   = _mm256_set1_epi8(0x0f);
+    size_t i = 0;
+
+    for (; n - i >= 32; i += 32) {
+        __m256i b  = _mm256_loadu_si256((const __m256i*)(bytes + i));
+        __m256i hi = _mm256_and_si256(_mm256_srli_epi16(b, 4), mask);
+        __m256i lo = _mm256_and_si256(b, mask);
+        // Per lane, x holds bytes 0-7 and 16-23, y bytes 8-15 and 24-31
+        __m256i x  = _mm256_shuffle_epi8(digits, _mm256_unpacklo_epi8(hi, lo));
+        __m256i y  = _mm256_shuffle_epi8(digits, _mm256_unpackhi_epi8(hi, lo));
+        _mm256_storeu_si256((__m256i*)(hex_str + 2*i     ), _mm256_permute2x128_si256(x, y, 0x20));
+        _mm256_storeu_si256((__m256i*)(hex_str + 2*i + 32), _mm256_permute2x128_si256(x, y, 0x31));
+    }
+    return i;
+}
+
+static size_t hex_decode_blocks(const char* hex_str, uint8_t* bytes, size_t n) {
+    size_t i = 0;
+    if (__builtin_cpu_supports("avx2")) i = hex_decode_avx2(hex_str, bytes, n);
+    if (__builtin_cpu_supports("sse4.1")) i += hex_decode_sse41(hex_str + 2*i, bytes + i, n - i);
+    return i;
+}
+
+static size_t hex_encode_blocks(const uint8_t* bytes, size_t n, char* hex_str) {
+    size_t i = 0;
+    if (__builtin_cpu_supports("avx2")) i = hex_encode_avx2(bytes, n, hex_str);
+    if (__builtin_cpu_supports("sse4.1")) i += hex_encode_sse41(bytes + i, n - i, hex_str + 2*i);
+    return i;
+}
+#elif defined(CODEC_NEON)
+// Same method as the x86 kernels, with vuzp splitting the high and low
+// nibbles and vst2 interleaving the digits
+static size_t hex_decode_blocks(const char* hex_str, uint8_t* bytes, size_t n) {
+    const uint8x16_t zero_char = vdupq_n_u8('0');
+    const uint8x16_t a_char    = vdupq_n_u8('a');
+    const uint8x16_t lower     = vdupq_n_u8(0x20);
+    const uint8x16_t nine      = vdupq_n_u8(9);
+    const uint8x16_t five      = vdupq_n_u8(5);
+    const uint8x16_t ten       = vdupq_n_u8(10);
+    size_t i = 0;
+
+    for (; n - i >= 8; i += 8) {
+        uint8x16_t c = vld1q_u8((const uint8_t*)hex_str + 2*i);
+        uint8x16_t d = vsubq_u8(c, zero_char);
+        uint8x16_t a = vsubq_u8(vorrq_u8(c, lower), a_char);
+        uint8x16_t is_digit  = vcleq_u8(d, nine);
+        uint8x16_t is_letter = vcleq_u8(a, five);
+        uint8x16_t v;
+        uint8x8x2_t nibbles;
+
+        if (vminvq_u8(vorrq_u8(is_digit, is_letter)) == 0) break;
+        v = vbslq_u8(is_digit, d, vaddq_u8(a, ten));
+        nibbles = vuzp_u8(vget_low_u8(v), vget_high_u8(v));
+        vst1_u8(bytes + i, vorr_u8(vshl_n_u8(nibbles.val[0], 4), nibbles.val[1]));
+    }
+    return i;
+}
+
+static size_t hex_encode_blocks(const uint8_t* bytes, size_t n, char* hex_str) {
+    const uint8x16_t digits = vld1q_u8((const uint8_t*)hex_digits);
+    const uint8x16_t mask   = vdupq_n_u8(0x0f);
+    size_t i = 0;
+
+    for (; n - i >= 16; i += 16) {
+        uint8x16_t b = vld1q_u8(bytes + i);
+        uint8x16x2_t out;
+        out.val[0] = vqtbl1q_u8(digits, vshrq_n_u8(b, 4));
+        out.val[1] = vqtbl1q_u8(digits, vandq_u8(b, mask));
+        vst2q_u8((uint8_t*)hex_str + 2*i, out);
+    }
+    return i;
+}
+#else
+static size_t hex_decode_blocks(const char* hex_str, uint8_t* bytes, size_t n) {
+    (void)hex_str;
+    (void)bytes;
+    (void)n;
+    return 0;
+}
+
+static size_t hex_encode_blocks(const uint8_t* bytes, size_t n, char* hex_str) {
+    (void)bytes;
+    (void)n;
+    (void)hex_str;
+    return 0;
+}
+#endif
+
+int microsui_hex_decode(const char* hex_str, uint8_t* bytes, size_t bytes_len, size_t* bad_offset) {
+    // 1. Whole vector blocks, then the rest (or the first bad block) one pair at a time
+    size_t i = hex_decode_blocks(hex_str, bytes, bytes_len);
+    i += hex_decode_scalar(hex_str + 2*i, bytes + i, bytes_len - i);
+    if (i == bytes_len) return 0;
+
+    // 2. Offset of the bad digit within the pair that stopped the scalar loop
+    if (bad_offset) *bad_offset = 2*i + (hex_val(hex_str[2*i]) > 0x0f ? 0 : 1);
+    return -1;
+}
+
+void microsui_hex_encode(const uint8_t* bytes, size_t bytes_len, char* hex_str) {
+    size_t i = hex_encode_blocks(bytes, bytes_len, hex_str);
+    hex_encode_scalar(bytes + i, bytes_len - i, hex_str + 2*i);
     hex_str[2 * bytes_len] = '\0';
-}
\ No newline at end of file
+}
+
+void hex_to_bytes(const char* hex_str, uint8_t* bytes, uint32_t bytes_len) {
+    size_t done = 0;
+    size_t bad;
+
+    // Invalid digits decode as 0, as they always have
+    while (microsui_hex_decode(hex_str + 2*done, bytes + done, bytes_len - done, &bad) != 0) {
+        uint8_t hi = hex_val(hex_str[2*done + (bad & ~(size_t)1)]);
+        uint8_t lo = hex_val(hex_str[2*done + (bad | 1)]);
+        done += bad / 2;
+        bytes[done++] = ((hi & 0xf0 ? 0 : hi) << 4) | (lo & 0xf0 ? 0 : lo);
+    }
+}
+
+void bytes_to_hex(const uint8_t* bytes, uint32_t bytes_len, char* hex_str) {
+    microsui_hex_encode(bytes, bytes_len, hex_str);
+}
+
+static const char base64_digits[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+// Value of a base64 digit, 0xff for any other character (padding included)
+static inline uint8_t base64_val(char c) {
+    uint8_t u = (uint8_t)c;
+    if (u >= 'A' && u <= 'Z') return u - 'A';
+    if (u >= 'a' && u <= 'z') return u - 'a' + 26;
+    if (u >= '0' && u <= '9') return u - '0' + 52;
+    if (u == '+') return 62;
+    if (u == '/') return 63;
+    return 0xff;
+}
+
+// Decodes the quad q into 3 - pad bytes, where pad is its number of trailing
+// '='. The bits under the padding must be zero. Returns 0, or -1 if invalid.
+static int base64_decode_quad(const char* q, size_t pad, uint8_t* bytes) {
+    uint8_t a = base64_val(q[0]);
+    uint8_t b = base64_val(q[1]);
+    uint8_t c = pad >= 2 ? 0 : base64_val(q[2]);
+    uint8_t d = pad >= 1 ? 0 : base64_val(q[3]);
+    uint32_t v = ((uint32_t)a << 18) | ((uint32_t)b << 12) | ((uint32_t)c << 6) | d;
+
+    if ((a | b | c | d) & 0xc0) return -1;
+    if ((pad == 1 && (v & 0xff) != 0) || (pad == 2 && (v & 0xffff) != 0)) return -1;
+    bytes[0] = (uint8_t)(v >> 16);
+    if (pad < 2) bytes[1] = (uint8_t)(v >> 8);
+    if (pad < 1) bytes[2] = (uint8_t)v;
+    return 0;
+}
+
+static void base64_encode_scalar(const uint8_t* bytes, size_t n, char* b64) {
+    for (size_t i = 0; i + 3 <= n; i += 3, b64 += 4) {
+        uint32_t v = ((uint32_t)bytes[i] << 16) | ((uint32_t)bytes[i + 1] << 8) | bytes[i + 2];
+        b64[0] = base64_digits[(v >> 18) & 0x3f];
+        b64[1] = base64_digits[(v >> 12) & 0x3f];
+        b64[2] = base64_digits[(v >>  6) & 0x3f];
+        b64[3] = base64_digits[ v        & 0x3f];
+    }
+}
+
+#ifdef CODEC_X86
+// Base64 kernels after W. Mula and D. Lemire, "Faster Base64 Encoding and
+// Decoding Using AVX2 Instructions". As for hex, decoding stops before the
+// first block with an invalid character.
+//
+// Decoding classifies each character by its two nibbles: a character is
+// valid when the lut_lo entry of its low nibble and the lut_hi entry of its
+// high nibble share no bit. lut_roll, indexed by the high nibble ('/' moved
+// to its own slot), holds the offset from character to value. maddubs and
+// madd then pack four 6-bit values into 24 bits, and pshufb drops the fourth
+// byte of each dword.
+//
+// Encoding spreads 3 bytes over the 4 bytes of a dword with pshufb, moves
+// each 6-bit field into place with mulhi and mullo, and turns the values
+// into characters with one offset per range (A-Z, a-z, 0-9, '+', '/').
+static CODEC_SSE41 size_t base64_decode_sse41(const char* b64, size_t n, uint8_t* bytes) {
+    const __m128i lut_lo = _mm_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+                                         0x11, 0x11, 0x13, 0x1a, 0x1b, 0x1b, 0x1b, 0x1a);
+    const __m128i lut_hi = _mm_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+                                         0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+    const __m128i lut_roll = _mm_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+    const __m128i nibble = _mm_set1_epi8(0x0f);
+    const __m128i slash  = _mm_set1_epi8('/');
+    const __m128i pack   = _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+    size_t i = 0;
+
+    for (; n - i >= 16; i += 16) {
+        __m128i c  = _mm_loadu_si128((const __m128i*)(b64 + i));
+        __m128i hi = _mm_and_si128(_mm_srli_epi32(c, 4), nibble);
+        __m128i lo = _mm_and_si128(c, nibble);
+        __m128i v;
+        uint8_t* out = bytes + i / 4 * 3;
+        uint32_t tail;
+
+        if (!_mm_testz_si128(_mm_shuffle_epi8(lut_lo, lo), _mm_shuffle_epi8(lut_hi, hi))) break;
+        v = _mm_add_epi8(c, _mm_shuffle_epi8(lut_roll, _mm_add_epi8(_mm_cmpeq_epi8(c, slash), hi)));
+        v = _mm_maddubs_epi16(v, _mm_set1_epi32(0x01400140));
+        v = _mm_madd_epi16(v, _mm_set1_epi32(0x00011000));
+        v = _mm_shuffle_epi8(v, pack);
+        _mm_storel_epi64((__m128i*)out, v);
+        tail = (uint32_t)_mm_extract_epi32(v, 2);
+        memcpy(out + 8, &tail, 4);
+    }
+    return i;
+}
+
+static CODEC_AVX2 size_t base64_decode_avx2(const char* b64, size_t n, uint8_t* bytes) {
+    const __m256i lut_lo = _mm256_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+                                            0x11, 0x11, 0x13, 0x1a, 0x1b, 0x1b, 0x1b, 0x1a,
+                                            0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+                                            0x11, 0x11, 0x13, 0x1a, 0x1b, 0x1b, 0x1b, 0x1a);
+    const __m256i lut_hi = _mm256_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+                                            0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+                                            0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+                                            0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+    const __m256i lut_roll = _mm256_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0,
+                                              0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+    const __m256i nibble = _mm256_set1_epi8(0x0f);
+    const __m256i slash  = _mm256_set1_epi8('/');
+    const __m256i pack   = _mm256_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+                                            2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+    size_t i = 0;
+
+    for (; n - i >= 32; i += 32) {
+        __m256i c  = _mm256_loadu_si256((const __m256i*)(b64 + i));
+        __m256i hi = _mm256_and_si256(_mm256_srli_epi32(c, 4), nibble);
+        __m256i lo = _mm256_and_si256(c, nibble);
+        __m256i v;
+        uint8_t* out = bytes + i / 4 * 3;
+
+        if (!_mm256_testz_si256(_mm256_shuffle_epi8(lut_lo, lo), _mm256_shuffle_epi8(lut_hi, hi))) break;
+        v = _mm256_add_epi8(c, _mm256_shuffle_epi8(lut_roll, _mm256_add_epi8(_mm256_cmpeq_epi8(c, slash), hi)));
+        v = _mm256_maddubs_epi16(v, _mm256_set1_epi32(0x01400140));
+        v = _mm256_madd_epi16(v, _mm256_set1_epi32(0x00011000));
+        v = _mm256_shuffle_epi8(v, pack);
+        // 12 bytes per lane: close the gap between the lanes
+        v = _mm256_permutevar8x32_epi32(v, _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 7, 7));
+        _mm_storeu_si128((__m128i*)out, _mm256_castsi256_si128(v));
+        _mm_storel_epi64((__m128i*)(out + 16), _mm256_extracti128_si256(v, 1));
+    }
+    return i;
+}
+
+// Reads 16 bytes per 12 encoded, so n must leave 4 bytes past the last block
+static CODEC_SSE41 size_t base64_encode_sse41(const uint8_t* bytes, size_t n, char* b64) {
+    const __m128i spread = _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1);
+    const __m128i shift_lut = _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                            '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62,
+                                            '/' - 63, 'A', 0, 0);
+    size_t i = 0;
+
+    for (; n - i >= 16; i += 12) {
+        __m128i in = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(bytes + i)), spread);
+        __m128i t0 = _mm_mulhi_epu16(_mm_and_si128(in, _mm_set1_epi32(0x0fc0fc00)), _mm_set1_epi32(0x04000040));
+        __m128i t1 = _mm_mullo_epi16(_mm_and_si128(in, _mm_set1_epi32(0x003f03f0)), _mm_set1_epi32(0x01000010));
+        __m128i idx = _mm_or_si128(t0, t1);
+        __m128i r = _mm_subs_epu8(idx, _mm_set1_epi8(51));
+        r = _mm_or_si128(r, _mm_and_si128(_mm_cmpgt_epi8(_mm_set1_epi8(26), idx), _mm_set1_epi8(13)));
+        _mm_storeu_si128((__m128i*)(b64 + i / 3 * 4), _mm_add_epi8(_mm_shuffle_epi8(shift_lut, r), idx));
+    }
+    return i;
+}
+
+// Reads 32 bytes per 24 encoded, so n must leave 8 bytes past the last block
+static CODEC_AVX2 size_t base64_encode_avx2(const uint8_t* bytes, size_t n, char* b64) {
+    const __m256i spread = _mm256_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1,
+                                           10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1);
+    const __m256i shift_lut = _mm256_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                               '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62,
+                                               '/' - 63, 'A', 0, 0,
+                                               'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                               '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62,
+                                               '/' - 63, 'A', 0, 0);
+    size_t i = 0;
+
+    for (; n - i >= 32; i += 24) {
+        // Bytes 0-11 to the low lane, 12-23 to the high lane
+        __m256i in = _mm256_permutevar8x32_epi32(_mm256_loadu_si256((const __m256i*)(bytes + i)),
+                                                 _mm256_setr_epi32(0, 1, 2, 0, 3, 4, 5, 0));
+        __m256i t0, t1, idx, r;
+
+        in = _mm256_shuffle_epi8(in, spread);
+        t0 = _mm256_mulhi_epu16(_mm256_and_si256(in, _mm256_set1_epi32(0x0fc0fc00)), _mm256_set1_epi32(0x04000040));
+        t1 = _mm256_mullo_epi16(_mm256_and_si256(in, _mm256_set1_epi32(0x003f03f0)), _mm256_set1_epi32(0x01000010));
+        idx = _mm256_or_si256(t0, t1);
+        r = _mm256_subs_epu8(idx, _mm256_set1_epi8(51));
+        r = _mm256_or_si256(r, _mm256_and_si256(_mm256_cmpgt_epi8(_mm256_set1_epi8(26), idx), _mm256_set1_epi8(13)));
+        _mm256_storeu_si256((__m256i*)(b64 + i / 3 * 4), _mm256_add_epi8(_mm256_shuffle_epi8(shift_lut, r), idx));
+    }
+    return i;
+}
+
+static size_t base64_decode_blocks(const char* b64, size_t n, uint8_t* bytes) {
+    size_t i = 0;
+    if (__builtin_cpu_supports("avx2")) i = base64_decode_avx2(b64, n, bytes);
+    if (__builtin_cpu_supports("sse4.1")) i += base64_decode_sse41(b64 + i, n - i, bytes + i / 4 * 3);
+    return i;
+}
+
+static size_t base64_encode_blocks(const uint8_t* bytes, size_t n, char* b64) {
+    size_t i = 0;
+    if (__builtin_cpu_supports("avx2")) i = base64_encode_avx2(bytes, n, b64);
+    if (__builtin_cpu_supports("sse4.1")) i += base64_encode_sse41(bytes + i, n - i, b64 + i / 3 * 4);
+    return i;
+}
+#elif defined(CODEC_NEON)
+// vld4 splits 64 characters into the four positions of their quads, and
+// vst3 interleaves the three decoded bytes again. Encoding runs the other
+// way, looking the 6-bit values up in the alphabet with vqtbl4.
+static inline uint8x16_t base64_values_neon(uint8x16_t c, uint8x16_t* valid) {
+    uint8x16_t upper = vsubq_u8(c, vdupq_n_u8('A'));
+    uint8x16_t lower = vsubq_u8(c, vdupq_n_u8('a'));
+    uint8x16_t digit = vsubq_u8(c, vdupq_n_u8('0'));
+    uint8x16_t is_upper = vcleq_u8(upper, vdupq_n_u8(25));
+    uint8x16_t is_lower = vcleq_u8(lower, vdupq_n_u8(25));
+    uint8x16_t is_digit = vcleq_u8(digit, vdupq_n_u8(9));
+    uint8x16_t is_plus  = vceqq_u8(c, vdupq_n_u8('+'));
+    uint8x16_t is_slash = vceqq_u8(c, vdupq_n_u8('/'));
+    uint8x16_t v = vandq_u8(is_slash, vdupq_n_u8(63));
+
+    v = vbslq_u8(is_plus, vdupq_n_u8(62), v);
+    v = vbslq_u8(is_digit, vaddq_u8(digit, vdupq_n_u8(52)), v);
+    v = vbslq_u8(is_lower, vaddq_u8(lower, vdupq_n_u8(26)), v);
+    v = vbslq_u8(is_upper, upper, v);
+    *valid = vandq_u8(*valid, vorrq_u8(vorrq_u8(is_upper, is_lower), vorrq_u8(is_digit, vorrq_u8(is_plus, is_slash))));
+    return v;
+}
+
+static size_t base64_decode_blocks(const char* b64, size_t n, uint8_t* bytes) {
+    size_t i = 0;
+
+    for (; n - i >= 64; i += 64) {
+        uint8x16x4_t c = vld4q_u8((const uint8_t*)b64 + i);
+        uint8x16_t valid = vdupq_n_u8(0xff);
+        uint8x16_t a = base64_values_neon(c.val[0], &valid);
+        uint8x16_t b = base64_values_neon(c.val[1], &valid);
+        uint8x16_t d = base64_values_neon(c.val[2], &valid);
+        uint8x16_t e = base64_values_neon(c.val[3], &valid);
+        uint8x16x3_t out;
+
+        if (vminvq_u8(valid) == 0) break;
+        out.val[0] = vorrq_u8(vshlq_n_u8(a, 2), vshrq_n_u8(b, 4));
+        out.val[1] = vorrq_u8(vshlq_n_u8(b, 4), vshrq_n_u8(d, 2));
+        out.val[2] = vorrq_u8(vshlq_n_u8(d, 6), e);
+        vst3q_u8(bytes + i / 4 * 3, out);
+    }
+    return i;
+}
+
+static size_t base64_encode_blocks(const uint8_t* bytes, size_t n, char* b64) {
+    const uint8x16_t mask = vdupq_n_u8(0x3f);
+    uint8x16x4_t digits;
+    size_t i = 0;
+
+    digits.val[0] = vld1q_u8((const uint8_t*)base64_digits);
+    digits.val[1] = vld1q_u8((const uint8_t*)base64_digits + 16);
+    digits.val[2] = vld1q_u8((const uint8_t*)base64_digits + 32);
+    digits.val[3] = vld1q_u8((const uint8_t*)base64_digits + 48);
+
+    for (; n - i >= 48; i += 48) {
+        uint8x16x3_t in = vld3q_u8(bytes + i);
+        uint8x16x4_t out;
+        out.val[0] = vqtbl4q_u8(digits, vshrq_n_u8(in.val[0], 2));
+        out.val[1] = vqtbl4q_u8(digits, vandq_u8(vorrq_u8(vshlq_n_u8(in.val[0], 4), vshrq_n_u8(in.val[1], 4)), mask));
+        out.val[2] = vqtbl4q_u8(digits, vandq_u8(vorrq_u8(vshlq_n_u8(in.val[1], 2), vshrq_n_u8(in.val[2], 6)), mask));
+        out.val[3] = vqtbl4q_u8(digits, vandq_u8(in.val[2], mask));
+        vst4q_u8((uint8_t*)b64 + i / 3 * 4, out);
+    }
+    return i;
+}
+#else
+static size_t base64_decode_blocks(const char* b64, size_t n, uint8_t* bytes) {
+    (void)b64;
+    (void)n;
+    (void)bytes;
+    return 0;
+}
+
+static size_t base64_encode_blocks(const uint8_t* bytes, size_t n, char* b64) {
+    (void)bytes;
+    (void)n;
+    (void)b64;
+    return 0;
+}
+#endif
+
+int microsui_base64_decode(const char* b64, size_t b64_len, uint8_t* bytes, size_t* bytes_len) {
+    size_t body, pad, i;
+
+    if (b64_len % 4 != 0) return -1;
+    if (b64_len == 0) {
+        *bytes_len = 0;
+        return 0;
+    }
+
+    // 1. Every quad but the last: whole vector blocks, then one at a time
+    body = b64_len - 4;
+    i = base64_decode_blocks(b64, body, bytes);
+    for (; i < body; i += 4) {
+        if (base64_decode_quad(b64 + i, 0, bytes + i / 4 * 3) != 0) return -1;
+    }
+
+    // 2. The last quad, which may end in one or two '='
+    pad = (b64[i + 3] == '=') ? ((b64[i + 2] == '=') ? 2 : 1) : 0;
+    if (base64_decode_quad(b64 + i, pad, bytes + i / 4 * 3) != 0) return -1;
+    *bytes_len = i / 4 * 3 + 3 - pad;
+    return 0;
+}
+
+void microsui_base64_encode(const uint8_t* bytes, size_t bytes_len, char* b64) {
+    size_t i = base64_encode_blocks(bytes, bytes_len, b64);
+    size_t rest = (bytes_len - i) % 3;
+
+    base64_encode_scalar(bytes + i, bytes_len - i - rest, b64 + i / 3 * 4);
+    b64 += (bytes_len - rest) / 3 * 4;
+    i = bytes_len - rest;
+
+    // Last one or two bytes, padded
+    if (rest != 0) {
+        uint32_t v = ((uint32_t)bytes[i] << 16) | (rest == 2 ? (uint32_t)bytes[i + 1] << 8 : 0);
+        *b64++ = base64_digits[(v >> 18) & 0x3f];
+        *b64++ = base64_digits[(v >> 12) & 0x3f];
+        *b64++ = rest == 2 ? base64_digits[(v >> 6) & 0x3f] : '=';
+        *b64++ = '=';
+    }
+    *b64 = '\0';
+}
+
+// Intent prefix of every signed transaction
+static const uint8_t tx_intent[3] = {
+    0x00, // scope: TransactionData
+    0x00, // version: V0
+    0x00, // appId: Sui
+};
+
+void microsui_tx_digest_init(crypto_blake2b_ctx* ctx) {
+    crypto_blake2b_init(ctx, 32);
+    crypto_blake2b_update(ctx, tx_intent, sizeof(tx_intent));
+}
+
+void microsui_tx_digest(uint8_t digest[32], const uint8_t* tx_bytes, size_t tx_len) {
+    crypto_blake2b_ctx ctx;
+    microsui_tx_digest_init(&ctx);
+    crypto_blake2b_update(&ctx, tx_bytes, tx_len);
+    crypto_blake2b_final(&ctx, digest);
+}
+
+void microsui_tx_digests(uint8_t digests[][32], const uint8_t* const tx_bytes[], const size_t tx_lens[], size_t n) {
+    size_t i = 0;
+
+    // 1. Eight lanes at a time, then four
+    for (; n - i >= 8; i += 8) {
+        uint8_t* hashes[8];
+        for (size_t l = 0; l < 8; l++) hashes[l] = digests[i + l];
+        crypto_blake2b_x8(hashes, 32, tx_intent, sizeof(tx_intent), tx_bytes + i, tx_lens + i);
+    }
+    if (n - i >= 4) {
+        uint8_t* hashes[4];
+        for (size_t l = 0; l < 4; l++) hashes[l] = digests[i + l];
+        crypto_blake2b_x4(hashes, 32, tx_intent, sizeof(tx_intent), tx_bytes + i, tx_lens + i);
+        i += 4;
+    }
+
+    // 2. The rest one by one
+    for (; i < n; i++) {
+        microsui_tx_digest(digests[i], tx_bytes[i], tx_lens[i]);
+    }
+}
@@ -1,8 +1,45 @@
 #ifndef UTILS_H
 #define UTILS_H
 
+#include <stdint.h>
+#include <stddef.h>
+#include "monocypher/monocypher.h"
+
+// Decodes the 2 * bytes_len hex digits (either case) of hex_str into bytes.
+// Returns 0, or -1 if a character is not a hex digit: its offset in hex_str
+// is then stored in *bad_offset (when not NULL), and only the bytes before it
+// are written.
+int microsui_hex_decode(const char* hex_str, uint8_t* bytes, size_t bytes_len, size_t* bad_offset);
+
+// Writes the 2 * bytes_len lowercase hex digits of bytes and a null terminator.
+void microsui_hex_encode(const uint8_t* bytes, size_t bytes_len, char* hex_str);
+
+// Decodes b64_len characters of padded standard base64 into bytes, which
+// must hold b64_len / 4 * 3 bytes, and stores the decoded size in *bytes_len.
+// Returns 0, or -1 if the length, a character or the padding is invalid.
+int microsui_base64_decode(const char* b64, size_t b64_len, uint8_t* bytes, size_t* bytes_len);
+
+// Writes the padded base64 form of bytes, (bytes_len + 2) / 3 * 4 characters,
+// and a null terminator.
+void microsui_base64_encode(const uint8_t* bytes, size_t bytes_len, char* b64);
+
+// As microsui_hex_decode(), but invalid digits decode as 0
 void hex_to_bytes(const char* hex_str, uint8_t* bytes, uint32_t bytes_len);
 
 void bytes_to_hex(const uint8_t* bytes, uint32_t bytes_len, char* hex_str);
 
+// Starts the intent digest of a transaction: BLAKE2b-256 with the intent
+// prefix (TransactionData, V0, Sui) already absorbed. Feed the transaction
+// bytes with crypto_blake2b_update() and finish with crypto_blake2b_final().
+void microsui_tx_digest_init(crypto_blake2b_ctx* ctx);
+
+// Intent digest of one transaction: BLAKE2b-256(00 00 00 || tx_bytes), the
+// message Sui signs
+void microsui_tx_digest(uint8_t digest[32], const uint8_t* tx_bytes, size_t tx_len);
+
+// Intent digests of n transactions: BLAKE2b-256(00 00 00 || tx_bytes[i]), the
+// message Sui signs. Hashes 8 or 4 transactions at a time with the
+// multi-buffer BLAKE2b, so it is much faster than one by one on hosts with SIMD.
+void microsui_tx_digests(uint8_t digests[][32], const uint8_t* const tx_bytes[], const size_t tx_lens[], size_t n);
+
 #endif
\ No newline at end of file
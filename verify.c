@@ -0,0 +1,68 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "verify.h"
+#include "utils.h"
+#include "microsui_config.h"
+#include "ed25519_backend.h"
+
+int microsui_verify_signature(const uint8_t sui_sig[97], const uint8_t* tx_bytes, size_t tx_len) {
+    // 1. Only the Ed25519 scheme is supported
+    if (sui_sig[0] != 0x00) return -1;
+
+    // 2. Rebuild the BLAKE2b digest of the message with the intent
+    uint8_t digest[32];
+    microsui_tx_digest(digest, tx_bytes, tx_len);
+
+    // 3. Verify the Ed25519 signature of the digest against the embedded public key
+    return microsui_ed25519_verify(sui_sig + 1, sui_sig + 65, digest, 32);
+}
+
+int microsui_verify_batch(const uint8_t* const sui_sigs[], const uint8_t* const tx_bytes[], const size_t tx_lens[],
+                          size_t n, int results[]) {
+    uint8_t digests[MICROSUI_VERIFY_BATCH_CHUNK][32];
+    const uint8_t* sigs[MICROSUI_VERIFY_BATCH_CHUNK];
+    const uint8_t* pubs[MICROSUI_VERIFY_BATCH_CHUNK];
+    const uint8_t* msgs[MICROSUI_VERIFY_BATCH_CHUNK];
+    size_t msg_lens[MICROSUI_VERIFY_BATCH_CHUNK];
+    const uint8_t* txs[MICROSUI_VERIFY_BATCH_CHUNK];
+    size_t tx_sizes[MICROSUI_VERIFY_BATCH_CHUNK];
+    size_t index[MICROSUI_VERIFY_BATCH_CHUNK];
+    int ret = 0;
+
+    for (size_t start = 0; start < n; start += MICROSUI_VERIFY_BATCH_CHUNK) {
+        size_t end = n - start < MICROSUI_VERIFY_BATCH_CHUNK ? n : start + MICROSUI_VERIFY_BATCH_CHUNK;
+        size_t count = 0;
+
+        // 1. Collect the Ed25519 signatures of the chunk and their intent digests
+        for (size_t i = start; i < end; i++) {
+            if (sui_sigs[i][0] != 0x00) {
+                results[i] = -1;
+                ret = -1;
+                continue;
+            }
+            txs[count] = tx_bytes[i];
+            tx_sizes[count] = tx_lens[i];
+            sigs[count] = sui_sigs[i] + 1;
+            pubs[count] = sui_sigs[i] + 65;
+            msgs[count] = digests[count];
+            msg_lens[count] = 32;
+            index[count] = i;
+            count++;
+        }
+        microsui_tx_digests(digests, txs, tx_sizes, count);
+
+        // 2. Check the whole chunk at once
+        if (microsui_ed25519_verify_batch(sigs, pubs, msgs, msg_lens, count) == 0) {
+            for (size_t j = 0; j < count; j++) results[index[j]] = 0;
+            continue;
+        }
+
+        // 3. At least one is invalid: fall back to single checks to find which
+        for (size_t j = 0; j < count; j++) {
+            results[index[j]] = microsui_ed25519_verify(sigs[j], pubs[j], msgs[j], msg_lens[j]);
+            if (results[index[j]] != 0) ret = -1;
+        }
+    }
+    return ret;
+}
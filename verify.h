@@ -0,0 +1,17 @@
+#ifndef VERIFY_H
+#define VERIFY_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Returns 0 if sui_sig (flag || signature || public key) is a valid Ed25519
+// Sui signature of the transaction bytes, -1 otherwise.
+int microsui_verify_signature(const uint8_t signature[97], const uint8_t* tx_bytes, size_t tx_len);
+
+// Verifies n Sui signatures with batched multi-scalar multiplications.
+// results[i] is set to 0 if signatures[i] is valid for tx_bytes[i], -1 otherwise.
+// Returns 0 if every signature is valid, -1 otherwise.
+int microsui_verify_batch(const uint8_t* const signatures[], const uint8_t* const tx_bytes[], const size_t tx_lens[],
+                          size_t n, int results[]);
+
+#endif
\ No newline at end of file